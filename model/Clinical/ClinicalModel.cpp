@@ -24,10 +24,12 @@
 #include "Clinical/ImmediateOutcomes.h"
 #include "Clinical/DecisionTree5Day.h"
 #include "Host/NeonatalMortality.h"
+#include "SimContext.h"
 #include "mon/reporting.h"
 #include "util/ModelOptions.h"
 #include "util/CommandLine.h"
 #include "util/errors.h"
+#include "util/parallel.h"
 #include "util/timeConversions.h"
 #include "schema/scenario.h"
 
@@ -185,46 +187,56 @@ void ClinicalModel::checkpoint (ostream& stream) {
 
 // ——— infant mortality ———
 
-// Infant death summaries (checkpointed).
-vector<int> infantDeaths;
-vector<int> infantIntervalsAtRisk;
+// Infant death summaries (checkpointed) are in SimContext.
 
 /// Non-malaria mortality in under 1year olds.
 /// Set by init ()
 double nonMalariaMortality;
 
 void InfantMortality::init( const OM::Parameters& parameters ){
-    infantDeaths.resize(sim::stepsPerYear());
-    infantIntervalsAtRisk.resize(sim::stepsPerYear());
     nonMalariaMortality=parameters[Parameters::NON_MALARIA_INFANT_MORTALITY];
 }
 
 void InfantMortality::preMainSimInit() {
-    std::fill(infantDeaths.begin(), infantDeaths.end(), 0);
-    std::fill(infantIntervalsAtRisk.begin(), infantIntervalsAtRisk.end(), 0);
+    SimContext& ctx = SimContext::current();
+    ctx.infantDeaths.assign( sim::stepsPerYear(), 0 );
+    ctx.infantIntervalsAtRisk.assign( sim::stepsPerYear(), 0 );
 }
 
 void InfantMortality::staticCheckpoint(istream& stream) {
-    infantDeaths & stream;
-    infantIntervalsAtRisk & stream;
+    SimContext& ctx = SimContext::current();
+    ctx.infantDeaths & stream;
+    ctx.infantIntervalsAtRisk & stream;
 }
 void InfantMortality::staticCheckpoint (ostream& stream) {
-    infantDeaths & stream;
-    infantIntervalsAtRisk & stream;
+    SimContext& ctx = SimContext::current();
+    ctx.infantDeaths & stream;
+    ctx.infantIntervalsAtRisk & stream;
+}
+
+// Record one infant-interval at risk (via util::parallel::accumulate)
+static void accumulateRisk(size_t index, double isDoomed) {
+    SimContext& ctx = SimContext::current();
+    if( ctx.infantIntervalsAtRisk.size() != sim::stepsPerYear() ){   // new context
+        ctx.infantDeaths.assign( sim::stepsPerYear(), 0 );
+        ctx.infantIntervalsAtRisk.assign( sim::stepsPerYear(), 0 );
+    }
+    ctx.infantIntervalsAtRisk[index] += 1;     // baseline
+    if (isDoomed != 0.0)
+        ctx.infantDeaths[index] += 1;  // deaths
 }
 
 void InfantMortality::reportRisk(size_t index, bool isDoomed) {
-    infantIntervalsAtRisk[index] += 1;     // baseline
-    if (isDoomed)
-        infantDeaths[index] += 1;  // deaths
+    util::parallel::accumulate( &accumulateRisk, index, isDoomed ? 1.0 : 0.0 );
 }
 
 double InfantMortality::allCause(){
+    const SimContext& ctx = SimContext::current();
     double infantPropSurviving=1.0;       // use to calculate proportion surviving
     for( size_t i = 0; i < sim::stepsPerYear(); i += 1 ){
         // multiply by proportion of infants surviving at each interval
-        infantPropSurviving *= double(infantIntervalsAtRisk[i] - infantDeaths[i])
-            / double(infantIntervalsAtRisk[i]);
+        infantPropSurviving *= double(ctx.infantIntervalsAtRisk[i] - ctx.infantDeaths[i])
+            / double(ctx.infantIntervalsAtRisk[i]);
     }
     // Child deaths due to malaria (per 1000), plus non-malaria child deaths. Deaths per 1000 births is the return unit.
     return (1.0 - infantPropSurviving) * 1000.0 + nonMalariaMortality;
@@ -23,6 +23,7 @@
 
 #include "Host/Human.h"
 #include "Episode.h"
+#include "util/arena.h"
 #include <memory>
 
 namespace scnXml{
@@ -43,7 +44,7 @@ namespace OM { namespace Clinical {
  * 
  * Reporting includes patient outcome and potentially drug usage and use of
  * RDTs (Rapid Diagnostic Tests) for costing purposes. */\
-class ClinicalModel
+class ClinicalModel : public util::ArenaObject
 {
 public:
     /// @brief Static functions
@@ -30,6 +30,7 @@
 #include "util/vectors.h"
 #include "util/StreamValidator.h"
 #include "Population.h"
+#include "SimContext.h"
 #include "interventions/InterventionManager.hpp"
 #include "mon/reporting.h"
 #include "schema/scenario.h"
@@ -90,7 +91,7 @@ Human::Human(SimTime dateOfBirth, int dummy) :
 
 // -----  Non-static functions: per-time-step update  -----
 
-vector<double> EIR_per_genotype;        // cache (not thread safe)
+thread_local vector<double> EIR_per_genotype;   // cache (per thread: see util/parallel.h)
 
 void Human::update(const Transmission::TransmissionModel& transmission) {
     // For integer age checks we use age0 to e.g. get 73 steps comparing less than 1 year old
@@ -164,7 +165,13 @@ void Human::summarize() {
 
 void Human::reportDeployment( ComponentId id, SimTime duration ){
     if( duration <= SimTime::zero() ) return; // nothing to do
-    m_subPopExp[id] = sim::nowOrTs1() + duration;
+    auto result = m_subPopExp.insert( make_pair( id, sim::nowOrTs1() + duration ) );
+    if( result.second ){
+        // new record: invalidates Population::subPopCandidates( id )
+        SimContext::current().joinSubPop( id.id );
+    }else{
+        result.first->second = sim::nowOrTs1() + duration;
+    }
     m_cohortSet = mon::updateCohortSet( m_cohortSet, id, true );
 }
 void Human::removeFirstEvent( interventions::SubPopRemove::RemoveAtCode code ){
@@ -129,6 +129,11 @@ public:
       if( it == m_subPopExp.end() ) return false;       // no history of membership
       else return it->second > sim::nowOrTs0();   // added: has expired?
   }
+  /** Return true if the human has any record of membership of the
+   * sub-population, current or expired (a superset of isInSubPop()). */
+  inline bool hasSubPopRecord( interventions::ComponentId id )const{
+      return m_subPopExp.count( id ) > 0;
+  }
   /** Return the cohort set. */
   inline uint32_t cohortSet()const{ return m_cohortSet; }
   
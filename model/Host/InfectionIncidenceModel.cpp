@@ -27,6 +27,7 @@
 #include "util/ModelOptions.h"
 #include "util/random.h"
 #include "util/errors.h"
+#include "util/parallel.h"
 
 #include <stdexcept>
 #include <cmath>
@@ -64,6 +65,9 @@ bool opt_neg_bin_mass_action = false, opt_lognormal_mass_action = false,
 
 // ———  variables  ———
 int InfectionIncidenceModel::ctsNewInfections = 0;
+void InfectionIncidenceModel::accumulateNewInfections( size_t, double n ){
+    ctsNewInfections += static_cast<int>(n);
+}
 
 // -----  static initialisation  -----
 
@@ -238,7 +242,7 @@ int InfectionIncidenceModel::numNewInfections (Human& human, double effectiveEIR
         n = WithinHost::WHInterface::MAX_INFECTIONS;
     }
     mon::reportEventMHI( mon::MHR_NEW_INFECTIONS, human, n );
-    ctsNewInfections += n;
+    util::parallel::accumulate( &accumulateNewInfections, 0, n );
     return n;
   }
   if ( (boost::math::isnan)(expectedNumInfections) ){	// check for not-a-number
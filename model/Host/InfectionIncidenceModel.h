@@ -24,6 +24,7 @@
 #include "Global.h"
 #include "Transmission/PerHost.h"
 #include "util/random.h"
+#include "util/arena.h"
 
 namespace OM {
     class Parameters;
@@ -43,7 +44,7 @@ using util::LocalRng;
  * 
  * There are also two susceptibility models which should be compatible with all
  * of these (see susceptibility()). */
-class InfectionIncidenceModel
+class InfectionIncidenceModel : public util::ArenaObject
 {
 public:
   ///@brief Static initialisation & constructors
@@ -126,6 +127,8 @@ protected:
   
     /// Number of new infections introduced, per continuous reporting period
     static int ctsNewInfections;
+    /// Add n to ctsNewInfections (via util::parallel::accumulate)
+    static void accumulateNewInfections( size_t, double n );
 };
 
 //TODO(optimisation): none of these add data members, so should we be using
@@ -20,6 +20,7 @@
 
 #include "Host/NeonatalMortality.h"
 #include "Population.h"
+#include "SimContext.h"
 #include "WithinHost/WHInterface.h"
 #include "WithinHost/Diagnostic.h"
 #include "util/random.h"
@@ -44,11 +45,13 @@ const double pBirthPrim = 0.3;
 const double y = pBirthPrim * gEst;
 const double z = -1.0 / critPrev2025;
 
-/// Probability for a newborn to die (indirect death) because the mother is infected.
-/// Depends on the prevalence of parasitaemia in mother at some previous t.
-double riskFromMaternalInfection = 0.0;
-/// Array of stored prevalences of mothers over last 5 months
-std::vector<double> prevByGestationalAge;
+// State is in SimContext: neonatalRisk is the probability for a newborn to
+// die (indirect death) because the mother is infected, depending on the
+// prevalence of parasitaemia in mothers at some previous t, which is stored
+// in neonatalPrev over the last 5 months.
+
+/// Length of SimContext::neonatalPrev (in time steps)
+size_t nPrevSteps = 0;
 
 /// Lower and upper bounds for potential mothers (as in model description)
 SimTime ageLb = SimTime::fromYearsI(20), ageUb = SimTime::fromYearsI(25);
@@ -60,7 +63,7 @@ const WithinHost::Diagnostic* neonatalDiagnostic = 0;
 
 void NeonatalMortality::init( const scnXml::Clinical& clinical ){
     SimTime fiveMonths = SimTime::fromDays( 5 * 30 );
-    prevByGestationalAge.assign( fiveMonths.inSteps(), 0.0 );
+    nPrevSteps = fiveMonths.inSteps();
     
     if( clinical.getNeonatalMortality().present() ){
         neonatalDiagnostic = &WithinHost::diagnostics::get(
@@ -77,16 +80,18 @@ void NeonatalMortality::init( const scnXml::Clinical& clinical ){
 }
 
 void NeonatalMortality::staticCheckpoint (istream& stream) {
-    riskFromMaternalInfection & stream;
-    prevByGestationalAge & stream;
+    SimContext& ctx = SimContext::current();
+    ctx.neonatalRisk & stream;
+    ctx.neonatalPrev & stream;
 }
 void NeonatalMortality::staticCheckpoint (ostream& stream) {
-    riskFromMaternalInfection & stream;
-    prevByGestationalAge & stream;
+    SimContext& ctx = SimContext::current();
+    ctx.neonatalRisk & stream;
+    ctx.neonatalPrev & stream;
 }
 
 bool NeonatalMortality::eventNeonatalMortality(LocalRng& rng) {
-  return rng.uniform_01() <= riskFromMaternalInfection;
+  return rng.uniform_01() <= SimContext::current().neonatalRisk;
 }
 
 void NeonatalMortality::update (Population& population) {
@@ -118,6 +123,11 @@ void NeonatalMortality::update (Population& population) {
     if( nCounter > 0 )
         prev2025 = double(pCounter) / nCounter;
     
+    SimContext& ctx = SimContext::current();
+    vector<double>& prevByGestationalAge = ctx.neonatalPrev;
+    if( prevByGestationalAge.size() != nPrevSteps )     // new context
+        prevByGestationalAge.assign( nPrevSteps, 0.0 );
+    
     double maxPrev = prev2025;
     //update the vector containing the prevalence by gestational age
     size_t index = sim::ts0().moduloSteps(prevByGestationalAge.size());
@@ -131,7 +141,7 @@ void NeonatalMortality::update (Population& population) {
     // equation (2) p 75 AJTMH 75 suppl 2
     double prevPG= maxPrev / (critPrevPrim + maxPrev);
     // equation (1) p 75 AJTMH 75 suppl 2 including 30% multiplier
-    riskFromMaternalInfection = y * (1.0-exp(prevPG * z));
+    ctx.neonatalRisk = y * (1.0-exp(prevPG * z));
 }
 
 } }
@@ -47,6 +47,7 @@ bool comp(pair<double,double> lhs, pair<double,double> rhs){
 // If two doses coincide, they can be combined but doing so is not essential.
 
 void LSTMDrug::medicate(double time, double qty){
+    clearFactorCache();
     // Insert in the right position to maintain sorting:
     auto elt = make_pair (time, qty);
     auto pos = lower_bound(doses.begin(), doses.end(), elt, comp);
@@ -54,5 +55,25 @@ void LSTMDrug::medicate(double time, double qty){
     assert(is_sorted(doses.begin(), doses.end(), comp));
 }
 
+bool LSTMDrug::findCachedFactor( uint32_t genotype, double Kn, double Kn2,
+        double body_mass, double& factor ) const
+{
+    // Usually there are only a few entries, so a linear search is fine.
+    foreach( const CachedFactor& c, factorCache ){
+        if( c.genotype == genotype && c.Kn == Kn && c.Kn2 == Kn2 &&
+                c.body_mass == body_mass ){
+            factor = c.factor;
+            return true;
+        }
+    }
+    return false;
+}
+
+void LSTMDrug::cacheFactor( uint32_t genotype, double Kn, double Kn2,
+        double body_mass, double factor ) const
+{
+    factorCache.push_back( CachedFactor{ genotype, Kn, Kn2, body_mass, factor } );
+}
+
 }
 }
@@ -25,6 +25,8 @@
 #include "util/checkpoint_containers.h"
 #include "util/random.h"
 
+class UnittestUtil;
+
 namespace OM {
 namespace WithinHost {
     class CommonInfection;
@@ -82,6 +84,12 @@ public:
      * @param body_mass Weight of patient in kg */
     virtual void updateConcentration (double body_mass) =0;
     
+    /** Forget drug factors memorised today. Must be called whenever
+     * concentrations or doses change (medicate() does so itself). */
+    inline void clearFactorCache(){
+        factorCache.clear();
+    }
+    
     /// Checkpointing
     template<class S>
     void operator& (S& stream) {
@@ -90,6 +98,21 @@ public:
     }
 
 protected:
+    /** Drug factors are a function of today's doses and concentrations, body
+     * mass, the infection's genotype (which determines PD parameters) and the
+     * IC50^slope values sampled for the infection (Kn; a second value is used
+     * by the conversion model for the metabolite, otherwise zero). Infections
+     * in one host often share all of these, so calculateDrugFactor()
+     * implementations memorise results until the next clearFactorCache().
+     *
+     * Kn must have been sampled before lookup so that random number usage is
+     * unchanged. Returns true and sets factor if found. */
+    bool findCachedFactor( uint32_t genotype, double Kn, double Kn2,
+            double body_mass, double& factor ) const;
+    /// Memorise a result of calculateDrugFactor()
+    void cacheFactor( uint32_t genotype, double Kn, double Kn2,
+            double body_mass, double factor ) const;
+    
     virtual void checkpoint (istream& stream){}
     virtual void checkpoint (ostream& stream){}
     
@@ -104,6 +127,18 @@ protected:
     
     /// Volume of distribution, sampled when this class is first created.
     double vol_dist;
+    
+private:
+    struct CachedFactor {
+        uint32_t genotype;
+        double Kn, Kn2, body_mass;
+        double factor;
+    };
+    /// Factors calculated since the last change of doses or concentrations.
+    /// Not checkpointed (it is only a cache).
+    mutable std::vector<CachedFactor> factorCache;
+    
+    friend class ::UnittestUtil;
 };
 
 }
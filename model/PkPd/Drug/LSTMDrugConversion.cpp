@@ -19,12 +19,12 @@
  */
 
 #include "PkPd/Drug/LSTMDrugConversion.h"
+#include "PkPd/Drug/LSTMIntegration.h"
 #include "WithinHost/Infection/CommonInfection.h"
 #include "util/errors.h"
 #include "util/StreamValidator.h"
 #include "util/vectors.h"
 
-#include <gsl/gsl_integration.h>
 #include <limits>
 
 using namespace std;
@@ -128,29 +128,17 @@ double func_convFactor( double t, void* pp ){
     return max(fCP,fCM);
 }
 
-const size_t GSL_INTG_CONV_MAX_ITER = 1000;     // 10 seems enough, but no harm in using a higher value
-gsl_integration_workspace *gsl_intgr_conv_wksp = gsl_integration_workspace_alloc (GSL_INTG_CONV_MAX_ITER);
-//NOTE: we "should" free, but mem-leaks at end of program aren't really important
-// gsl_integration_workspace_free (gsl_intgr_conv_wksp);
 double LSTMDrugConversion::calculateFactor(const Params_convFactor& p, double duration) const{
-    gsl_function F;
-    F.function = &func_convFactor;
-    // gsl_function doesn't accept const; we re-apply const later
-    F.params = static_cast<void*>(const_cast<Params_convFactor*>(&p));
-    
     // We use exp(-result), so small absolute differences can matter (but also
     // using smaller abs_eps is cheap). We likely don't need high rel precision.
     const double abs_eps = 1e-5, rel_eps = 1e-2;
-    // NOTE: 1 through 6 are different algorithms of increasing complexity
-    const int qag_rule = 1;     // alg 1 seems to be good enough
-    double intfC, err_eps;      // intfC will carry our result; err_eps is a measure of accuracy of the result
+    double err_eps;     // a measure of accuracy of the result
     
 //     intg_steps = 0;
-    int r = gsl_integration_qag (&F, 0.0, duration, abs_eps, rel_eps,
-                                 GSL_INTG_CONV_MAX_ITER, qag_rule, gsl_intgr_conv_wksp, &intfC, &err_eps);
-    if( r != 0 ){
-        throw TRACED_EXCEPTION( "calculateFactor: error from gsl_integration_qag",util::Error::GSL );
-    }
+    // integrate doesn't accept const; we re-apply const later
+    double intfC = LSTMIntegration::integrate( &func_convFactor,
+            static_cast<void*>(const_cast<Params_convFactor*>(&p)), duration,
+            abs_eps, rel_eps, err_eps );
     // Testing err_eps is redundant with GSL's built-in tests
 //     cout << "integration steps: " << intg_steps << endl;
 //     cout << "duration: " << duration << ", AUC: " << intfC << endl;
@@ -222,6 +210,9 @@ double LSTMDrugConversion::calculateDrugFactor(LocalRng& rng, WithinHost::Common
     
     double time = 0.0;  // time since start of day
     double totalFactor = 1.0;   // survival factor for whole day
+    if( findCachedFactor(inf->genotype(), p.KnP, p.KnM, body_mass, totalFactor) ){
+        return totalFactor;
+    }
     
     typedef pair<double,double> TimeConc;
     foreach( const TimeConc& time_conc, doses ){
@@ -246,6 +237,7 @@ double LSTMDrugConversion::calculateDrugFactor(LocalRng& rng, WithinHost::Common
         totalFactor *= calculateFactor(p, 1.0 - time);
     }
     
+    cacheFactor(inf->genotype(), p.KnP, p.KnM, body_mass, totalFactor);
     return totalFactor;
 }
 
@@ -61,6 +61,9 @@ double LSTMDrugOneComp::calculateDrugFactor(LocalRng& rng, WithinHost::CommonInf
     
     const LSTMDrugPD& drugPD = typeData.getPD(inf->genotype());
     const double Kn = drugPD.IC50_pow_slope(rng, typeData.getIndex(), inf);
+    if( findCachedFactor(inf->genotype(), Kn, 0.0, body_mass, totalFactor) ){
+        return totalFactor;
+    }
     
     double time = 0.0;
     typedef pair<double,double> TimeConc;
@@ -81,6 +84,7 @@ double LSTMDrugOneComp::calculateDrugFactor(LocalRng& rng, WithinHost::CommonInf
         totalFactor *= drugPD.calcFactor( Kn, neg_elim_rate, &concentration_today, 1.0 - time );
     }
     
+    cacheFactor(inf->genotype(), Kn, 0.0, body_mass, totalFactor);
     return totalFactor; // Drug effect per day per drug per parasite
 }
 
@@ -19,12 +19,12 @@
  */
 
 #include "PkPd/Drug/LSTMDrugThreeComp.h"
+#include "PkPd/Drug/LSTMIntegration.h"
 #include "WithinHost/Infection/CommonInfection.h"
 #include "util/errors.h"
 #include "util/StreamValidator.h"
 
 #include <boost/math/constants/constants.hpp>
-#include <gsl/gsl_integration.h>
 #include <limits>
 
 using namespace std;
@@ -123,27 +123,14 @@ double func_fC( double t, void* pp ){
     const double fC = p.V * cn / (cn + p.Kn);       // unitless
     return fC;
 }
-const size_t GSL_INTG_MAX_ITER = 1000;     // 10 seems enough, but no harm in using a higher value
-gsl_integration_workspace *gsl_intgr_wksp = gsl_integration_workspace_alloc (GSL_INTG_MAX_ITER);
-//NOTE: we "should" free, but mem-leaks at end of program aren't really important
-// gsl_integration_workspace_free (gsl_intgr_wksp);
 double LSTMDrugThreeComp::calculateFactor(const Params_fC& p, double duration) const{
-    gsl_function F;
-    F.function = &func_fC;
-    // gsl_function doesn't accept const; we re-apply const later
-    F.params = static_cast<void*>(const_cast<Params_fC*>(&p));
-    
     // NOTE: tolerances are arbitrary, but seem to be sufficient
     const double abs_eps = 1e-2, rel_eps = 1e-2;
-    // NOTE: 1 through 6 are different algorithms of increasing complexity
-    const int qag_rule = 1;     // alg 1 seems to be good enough
-    double intfC, err_eps;
-    
-    int r = gsl_integration_qag (&F, 0.0, duration, abs_eps, rel_eps,
-                                 GSL_INTG_MAX_ITER, qag_rule, gsl_intgr_wksp, &intfC, &err_eps);
-    if( r != 0 ){
-        throw TRACED_EXCEPTION( "calculateFactor: error from gsl_integration_qag",util::Error::GSL );
-    }
+    double err_eps;
+    // integrate doesn't accept const; we re-apply const later
+    double intfC = LSTMIntegration::integrate( &func_fC,
+            static_cast<void*>(const_cast<Params_fC*>(&p)), duration,
+            abs_eps, rel_eps, err_eps );
     if( err_eps > 5e-2 ){
         // This could be a warning, except that warnings tend to be ignored.
         ostringstream msg;
@@ -169,6 +156,9 @@ double LSTMDrugThreeComp::calculateDrugFactor(LocalRng& rng, WithinHost::CommonI
     
     double time = 0.0;  // time since start of day
     double totalFactor = 1.0;   // survival factor for whole day
+    if( findCachedFactor(inf->genotype(), p.Kn, 0.0, body_mass, totalFactor) ){
+        return totalFactor;
+    }
     
     typedef pair<double,double> TimeConc;
     foreach( const TimeConc& time_conc, doses ){
@@ -196,6 +186,7 @@ double LSTMDrugThreeComp::calculateDrugFactor(LocalRng& rng, WithinHost::CommonI
         totalFactor *= calculateFactor(p, 1.0 - time);
     }
     
+    cacheFactor(inf->genotype(), p.Kn, 0.0, body_mass, totalFactor);
     return totalFactor;
 }
 
@@ -0,0 +1,111 @@
+/* This file is part of OpenMalaria.
+ *
+ * Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ * Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+ *
+ * OpenMalaria is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "PkPd/Drug/LSTMIntegration.h"
+#include "util/errors.h"
+
+#include <gsl/gsl_integration.h>
+#include <cmath>
+#include <algorithm>
+
+namespace OM { namespace PkPd { namespace LSTMIntegration {
+
+namespace {
+Method s_method = QAG;
+}
+
+void setMethod( Method method ){
+    s_method = method;
+}
+Method method(){
+    return s_method;
+}
+
+namespace {
+const size_t GSL_INTG_MAX_ITER = 1000;     // 10 seems enough, but no harm in using a higher value
+// Integration workspace: one per thread since humans may be updated in
+// parallel (see util/parallel.h); freed when the thread exits.
+struct IntgrWorkspace {
+    IntgrWorkspace() : w( gsl_integration_workspace_alloc (GSL_INTG_MAX_ITER) ) {}
+    ~IntgrWorkspace() { gsl_integration_workspace_free (w); }
+    gsl_integration_workspace *w;
+};
+thread_local IntgrWorkspace gsl_intgr_wksp;
+
+double integrateQAG( Function f, void* params, double duration,
+        double abs_eps, double rel_eps, double& err_eps )
+{
+    gsl_function F;
+    F.function = f;
+    F.params = params;
+    
+    // NOTE: 1 through 6 are different algorithms of increasing complexity
+    const int qag_rule = 1;     // alg 1 seems to be good enough
+    double result;
+    
+    int r = gsl_integration_qag (&F, 0.0, duration, abs_eps, rel_eps,
+                                 GSL_INTG_MAX_ITER, qag_rule, gsl_intgr_wksp.w, &result, &err_eps);
+    if( r != 0 ){
+        throw TRACED_EXCEPTION( "calculateFactor: error from gsl_integration_qag",util::Error::GSL );
+    }
+    return result;
+}
+
+// Positive nodes and weights of the 8-point Gauss-Legendre rule on [-1, 1]
+const double GL8_X[4] = { 0.1834346424956498, 0.5255324099163290,
+    0.7966664774136267, 0.9602898564975363 };
+const double GL8_W[4] = { 0.3626837833783620, 0.3137066458778873,
+    0.2223810344533745, 0.1012285362903763 };
+// Weights of the interpolatory rule on nodes ±GL8_X[1], ±GL8_X[3], exact for
+// polynomials of degree 3: solve w1 + w3 = 1 and w1 x1² + w3 x3² = 1/3.
+const double EMB_W3 = (1.0/3.0 - GL8_X[1]*GL8_X[1]) / (GL8_X[3]*GL8_X[3] - GL8_X[1]*GL8_X[1]);
+const double EMB_W1 = 1.0 - EMB_W3;
+// Accept the 8-point result when its error estimate is within this fraction of the tolerance
+const double GL_SAFETY = 0.1;
+}
+
+double integrate( Function f, void* params, double duration,
+        double abs_eps, double rel_eps, double& err_eps )
+{
+    if( s_method == GAUSS_LEGENDRE ){
+        const double half = 0.5 * duration;
+        double fx[8];   // f at -x3, ..., -x0, x0, ..., x3 (scaled to [0, duration])
+        for( size_t i = 0; i < 4; ++i ){
+            fx[3-i] = f( half - half * GL8_X[i], params );
+            fx[4+i] = f( half + half * GL8_X[i], params );
+        }
+        double result = 0.0;
+        for( size_t i = 0; i < 4; ++i ){
+            result += GL8_W[i] * (fx[3-i] + fx[4+i]);
+        }
+        result *= half;
+        const double embedded = half * (EMB_W1 * (fx[2] + fx[5]) + EMB_W3 * (fx[0] + fx[7]));
+        err_eps = std::abs( result - embedded );
+        // The estimate can be optimistic where the integrand changes sharply
+        // (e.g. absorption just after a dose), hence the safety factor.
+        if( err_eps <= GL_SAFETY * std::max( abs_eps, rel_eps * std::abs( result ) ) ){
+            return result;
+        }
+        // otherwise fall back to the adaptive method
+    }
+    return integrateQAG( f, params, duration, abs_eps, rel_eps, err_eps );
+}
+
+} } }
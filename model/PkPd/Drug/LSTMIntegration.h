@@ -0,0 +1,69 @@
+/* This file is part of OpenMalaria.
+ *
+ * Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ * Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+ *
+ * OpenMalaria is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef Hmod_LSTMIntegration
+#define Hmod_LSTMIntegration
+
+#include <cstddef>
+
+namespace OM { namespace PkPd {
+
+/** Integration of drug killing functions over (part of) a day, used by the
+ * LSTMDrugThreeComp and LSTMDrugConversion models.
+ *
+ * Two engines are available. QAG (the default) uses GSL's adaptive
+ * gsl_integration_qag. GAUSS_LEGENDRE uses a fixed 8-point Gauss-Legendre
+ * rule, with an error estimate from a 4-point rule on a subset of the same
+ * nodes (so no extra evaluations); unless this estimate is well within the
+ * tolerance, the integral is recomputed with QAG. Killing functions are smooth over the
+ * intervals used (doses split the day), so the fixed rule usually suffices and
+ * needs about half the function evaluations. */
+namespace LSTMIntegration {
+    enum Method {
+        QAG,
+        GAUSS_LEGENDRE
+    };
+    
+    /// Select the engine (set from the command line; default QAG)
+    void setMethod( Method method );
+    /// Get the engine in use
+    Method method();
+    
+    /// A function to integrate, taking a variable and a parameter pointer
+    typedef double (*Function) (double t, void* params);
+    
+    /** Integrate f over [0, duration].
+     * 
+     * @param f Function to integrate
+     * @param params Parameters passed to f
+     * @param duration Upper bound of integration (lower bound is 0)
+     * @param abs_eps Absolute error tolerance
+     * @param rel_eps Relative error tolerance (integration stops when the
+     *  estimated error is less than either tolerance)
+     * @param err_eps Set to the estimated absolute error
+     * @returns The integral
+     * 
+     * Throws a GSL error when QAG fails. */
+    double integrate( Function f, void* params, double duration,
+            double abs_eps, double rel_eps, double& err_eps );
+}
+
+} }
+#endif
@@ -20,12 +20,14 @@
 
 #include "PkPd/Drug/LSTMDrugType.h"
 #include "PkPd/Drug/LSTMDrugOneComp.h"
+#include "PkPd/Drug/LSTMIntegration.h"
 #include "PkPd/LSTMModel.h"
 #include "PkPd/LSTMMedicate.h"
 #include "PkPd/LSTMTreatments.h"
 #include "mon/reporting.h"
 #include "util/checkpoint_containers.h"
 #include "util/errors.h"
+#include "util/CommandLine.h"
 
 #include "schema/scenario.h"
 
@@ -36,6 +38,9 @@ namespace OM { namespace PkPd {
 // ———  static  ———
 
 void LSTMModel::init( const scnXml::Scenario& scenario ){
+    LSTMIntegration::setMethod(
+        util::CommandLine::option( util::CommandLine::DRUG_INTEGRATION_GL ) ?
+        LSTMIntegration::GAUSS_LEGENDRE : LSTMIntegration::QAG );
     if (scenario.getPharmacology().present()) {
         LSTMDrugType::init(scenario.getPharmacology().get().getDrugs());
         LSTMTreatments::init(scenario.getPharmacology().get().getTreatments());
@@ -146,6 +151,7 @@ void LSTMModel::decayDrugs (double body_mass) {
     // Update concentrations for each drug.
     // TODO: previously we removed drugs with negligible concentration here. What now, just set concentration to 0?
     foreach( auto& drug, m_drugs ){
+        drug->clearFactorCache();
         drug->updateConcentration(body_mass);
     }
 }
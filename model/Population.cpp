@@ -19,6 +19,7 @@
  */
 
 #include "Population.h"
+#include "SimContext.h"
 #include "mon/Continuous.h"
 
 #include "Host/Human.h"
@@ -32,10 +33,14 @@
 #include "util/errors.h"
 #include "util/random.h"
 #include "util/ModelOptions.h"
+#include "util/parallel.h"
+#include "util/arena.h"
 #include "util/StreamValidator.h"
 #include <schema/scenario.h>
 
 #include <cmath>
+#include <algorithm>
+#include <sstream>
 #include <boost/format.hpp>
 #include <boost/assign.hpp>
 
@@ -74,7 +79,8 @@ void Population::staticCheckpoint (ostream& stream)
 // -----  non-static methods: creation/destruction, checkpointing  -----
 
 Population::Population(size_t populationSize)
-    : populationSize (populationSize), recentBirths(0)
+    : populationSize (populationSize), recentBirths(0),
+    fullPopulationSize(0), sampleWeight(1.0)
 {
     using mon::Continuous;
     Continuous.registerCallback( "hosts", "\thosts", MakeDelegate( this, &Population::ctsHosts ) );
@@ -117,10 +123,14 @@ void Population::checkpoint (istream& stream)
     populationSize & stream;
     recentBirths & stream;
     
+    subPopIndex.clear();
+    population.reserve( populationSize );
+    size_t arenaUsed = util::arena::bytesInUse();
     for(size_t i = 0; i < populationSize && !stream.eof(); ++i) {
         // Note: calling this constructor of Host::Human is slightly wasteful, but avoids the need for another
         // ctor and leaves less opportunity for uninitialized memory.
         population.push_back( Host::Human (0, 0, SimTime::zero()) );
+        if( i == 0 ) reserveSubModels( arenaUsed );
         population.back() & stream;
     }
     if (population.size() != populationSize)
@@ -129,6 +139,7 @@ void Population::checkpoint (istream& stream)
 }
 void Population::checkpoint (ostream& stream)
 {
+    assert( fullPopulation.empty() );   // not sampling
     populationSize & stream;
     recentBirths & stream;
     
@@ -144,6 +155,14 @@ void Population::preMainSimInit ()
     recentBirths = 0;
 }
 
+void Population::reserveSubModels( size_t arenaUsed ){
+    // Sub-models of the first human used (bytesInUse() - arenaUsed); allocate
+    // space for those of the rest of the population in one go, so that each
+    // human's sub-models are adjacent and humans are in order in memory.
+    size_t perHuman = util::arena::bytesInUse() - arenaUsed;
+    util::arena::reserve( perHuman * (populationSize - 1) );
+}
+
 void Population::createInitialHumans()
 {
     /* We create a whole population here, regardless of whether humans can
@@ -151,6 +170,8 @@ void Population::createInitialHumans()
     structure in any case). However, we don't update humans known not to survive
     until vector init, which saves computation and memory (no infections). */
     
+    population.reserve( populationSize );
+    size_t arenaUsed = util::arena::bytesInUse();
     int cumulativePop = 0;
     for(size_t iage_prev = AgeStructure::getMaxTStepsPerLife(), iage = iage_prev - 1;
          iage_prev > 0; iage_prev = iage, iage -= 1 )
@@ -159,9 +180,10 @@ void Population::createInitialHumans()
         while (cumulativePop < targetPop) {
             SimTime dob = SimTime::zero() - SimTime::fromTS(iage);
             util::streamValidate( dob.inDays() );
-            uint64_t seed1 = util::master_RNG.gen_seed();
-            uint64_t seed2 = util::master_RNG.gen_seed();
+            uint64_t seed1 = SimContext::current().masterRng.gen_seed();
+            uint64_t seed2 = SimContext::current().masterRng.gen_seed();
             population.push_back( Host::Human (seed1, seed2, dob) );
+            if( cumulativePop == 0 ) reserveSubModels( arenaUsed );
             ++cumulativePop;
         }
     }
@@ -172,8 +194,148 @@ void Population::createInitialHumans()
 }
 
 
+void Population::beginSample( size_t n, uint64_t seed1, uint64_t seed2 ){
+    assert( fullPopulation.empty() && n > 0 && n < population.size() );
+    const size_t N = population.size();
+    vector<double> ages( N ), het( N );
+    for( size_t i = 0; i < N; ++i ){
+        ages[i] = population[i].age(sim::now()).inYears();
+        het[i] = population[i].perHostTransmission.relativeAvailabilityHet();
+    }
+    util::LocalRng rng( seed1, seed2 );
+    const vector<size_t> selected = selectSample( ages, het, n, rng );
+    
+    // Humans are copied by checkpointing, as when loading a checkpoint
+    stringstream copy;
+    foreach( size_t i, selected ){
+        population[i] & static_cast<ostream&>(copy);
+    }
+    HumanPop sample;
+    sample.reserve( n );
+    for( size_t k = 0; k < n; ++k ){
+        sample.push_back( Host::Human (0, 0, SimTime::zero()) );
+        sample.back() & static_cast<istream&>(copy);
+    }
+    swapInSample( sample );
+}
+
+vector<size_t> Population::selectSample( const vector<double>& ages,
+        const vector<double>& het, size_t n, util::LocalRng& rng )
+{
+    // Upper bounds of age bands (years); the last band is open
+    const double ageBounds[] = { 1.0, 5.0, 10.0, 15.0, 25.0, 45.0 };
+    const size_t nAgeBands = sizeof(ageBounds) / sizeof(ageBounds[0]) + 1;
+    const size_t nHetBands = 4;
+    const size_t N = ages.size();
+    assert( het.size() == N && n <= N );
+    
+    vector<double> sorted( het );
+    sort( sorted.begin(), sorted.end() );
+    double hetBounds[nHetBands - 1];
+    for( size_t q = 1; q < nHetBands; ++q ){
+        hetBounds[q - 1] = sorted[q * N / nHetBands];
+    }
+    
+    vector<vector<size_t>> strata( nAgeBands * nHetBands );
+    for( size_t i = 0; i < N; ++i ){
+        size_t a = upper_bound( ageBounds, ageBounds + nAgeBands - 1, ages[i] ) - ageBounds;
+        size_t h = upper_bound( hetBounds, hetBounds + nHetBands - 1, het[i] ) - hetBounds;
+        strata[a * nHetBands + h].push_back( i );
+    }
+    
+    // Proportional allocation; the remainder goes to the largest fractions
+    vector<size_t> alloc( strata.size() );
+    vector<pair<double, size_t> > fractions;
+    size_t allocated = 0;
+    for( size_t s = 0; s < strata.size(); ++s ){
+        const double exact = double(n) * strata[s].size() / N;
+        alloc[s] = static_cast<size_t>( floor( exact ) );
+        allocated += alloc[s];
+        fractions.push_back( make_pair( exact - alloc[s], s ) );
+    }
+    sort( fractions.rbegin(), fractions.rend() );
+    for( size_t k = 0; allocated < n; ++k, ++allocated ){
+        alloc[fractions[k].second] += 1;
+    }
+    
+    // Select without replacement within strata (partial Fisher-Yates), then
+    // restore population order (oldest to youngest)
+    vector<size_t> selected;
+    selected.reserve( n );
+    for( size_t s = 0; s < strata.size(); ++s ){
+        vector<size_t>& stratum = strata[s];
+        for( size_t k = 0; k < alloc[s]; ++k ){
+            size_t j = k + static_cast<size_t>( rng.uniform_01() * (stratum.size() - k) );
+            swap( stratum[k], stratum[j] );
+            selected.push_back( stratum[k] );
+        }
+    }
+    sort( selected.begin(), selected.end() );
+    return selected;
+}
+
+void Population::swapInSample( HumanPop& sample ){
+    assert( fullPopulation.empty() && !sample.empty() );
+    fullPopulation.swap( population );
+    population.swap( sample );
+    subPopIndex.clear();
+    fullPopulationSize = populationSize;
+    populationSize = population.size();
+    sampleWeight = double(fullPopulationSize) / populationSize;
+}
+
+void Population::endSample(){
+    assert( !fullPopulation.empty() );
+    population.swap( fullPopulation );
+    HumanPop().swap( fullPopulation );  // free the sample
+    subPopIndex.clear();
+    populationSize = fullPopulationSize;
+    sampleWeight = 1.0;
+}
+
+
 // -----  non-static methods: simulation loop  -----
 
+int Population::removeHumans( HumanPop& population, int targetPop,
+        vector<size_t> *newIndex )
+{
+    // Stable compaction: humans are kept in order (oldest to youngest) by
+    // moving each survivor down over any removed before it, then truncating.
+    // Erasing humans one at a time would shift all younger humans per removal.
+    size_t next = 0;    // index at which to store the next survivor
+    int cumPop = 0;
+    if( newIndex ) newIndex->assign( population.size(), SIZE_MAX );
+    for( size_t i = 0; i < population.size(); ++i ){
+        Host::Human& human = population[i];
+        bool isDead = human.remove();
+        // if (Actual number of people so far > target population size for this age)
+        // "outmigrate" some to maintain population shape
+        //NOTE: better to use age(sim::ts0())? Possibly, but the difference will not be very significant.
+        // Also see targetPop = ... comment in update()
+        bool outmigrate = cumPop >= AgeStructure::targetCumPop(human.age(sim::ts1()).inSteps(), targetPop);
+        
+        if( isDead || outmigrate ) continue;
+        if( newIndex ) (*newIndex)[i] = next;
+        if( next != i ) population[next] = std::move( human );
+        ++next;
+        ++cumPop;
+    }
+    population.erase( population.begin() + next, population.end() );
+    return cumPop;
+}
+
+void Population::remapSubPopIndex( const vector<size_t>& newIndex ){
+    for( auto& entry : subPopIndex ){
+        // Mapping preserves order, so the list stays sorted
+        vector<size_t>& members = entry.second.members;
+        size_t next = 0;
+        for( size_t i : members ){
+            if( newIndex[i] != SIZE_MAX ) members[next++] = newIndex[i];
+        }
+        members.resize( next );
+    }
+}
+
 void Population::update( const Transmission::TransmissionModel& transmission, SimTime firstVecInitTS ){
     // This should only use humans being updated: otherwise too small a proportion
     // will be infected. However, we don't have another number to use instead.
@@ -181,52 +343,80 @@ void Population::update( const Transmission::TransmissionModel& transmission, Si
     // (until humans old enough to be pregnate get updated and can be infected).
     Host::NeonatalMortality::update (*this);
     
-    // Update each human in turn
-    for (Host::Human& human : population) {
-        // Update human, and remove if too old.
-        // We only need to update humans who will survive past the end of the
-        // "one life span" init phase (this is an optimisation). lastPossibleTS
-        // is the time step they die at (some code still runs on this step).
-        SimTime lastPossibleTS = human.getDateOfBirth() + sim::maxHumanAge();   // this is last time of possible update
-        if (lastPossibleTS >= firstVecInitTS)
-            human.update(transmission);
-    }
+    // Update each human. Humans are independent (each has its own RNG) so
+    // this may be split over several threads; updates to shared state are
+    // deferred and applied in population order (see util/parallel.h).
+    util::parallel::forChunks( population.size(), [&]( size_t begin, size_t end ){
+        for( size_t i = begin; i < end; ++i ){
+            Host::Human& human = population[i];
+            // Update human, and remove if too old.
+            // We only need to update humans who will survive past the end of the
+            // "one life span" init phase (this is an optimisation). lastPossibleTS
+            // is the time step they die at (some code still runs on this step).
+            SimTime lastPossibleTS = human.getDateOfBirth() + sim::maxHumanAge();   // this is last time of possible update
+            if (lastPossibleTS >= firstVecInitTS)
+                human.update(transmission);
+        }
+    } );
     
     //NOTE: other parts of code are not set up to handle changing population size. Also
     // populationSize is assumed to be the _actual and exact_ population size by other code.
     //targetPop is the population size at time t allowing population growth
     //int targetPop = (int) (populationSize * exp( AgeStructure::rho * sim::ts1().inSteps() ));
     int targetPop = populationSize;
-    int cumPop = 0;
-
-    for (Iter iter = population.begin(); iter != population.end();) {
-        bool isDead = iter->remove();
-        // if (Actual number of people so far > target population size for this age)
-        // "outmigrate" some to maintain population shape
-        //NOTE: better to use age(sim::ts0())? Possibly, but the difference will not be very significant.
-        // Also see targetPop = ... comment above
-        bool outmigrate = cumPop >= AgeStructure::targetCumPop(iter->age(sim::ts1()).inSteps(), targetPop);
-        
-        if( isDead || outmigrate ){
-            iter = population.erase (iter);
-            continue;
-        }
-        ++cumPop;
-        ++iter;
-    } // end of per-human updates
+    int cumPop;
+    if( subPopIndex.empty() ){
+        cumPop = removeHumans( population, targetPop );
+    }else{
+        cumPop = removeHumans( population, targetPop, &newIndexBuffer );
+        remapSubPopIndex( newIndexBuffer );
+    }
 
     // increase population size to targetPop
     recentBirths += (targetPop - cumPop);
     while (cumPop < targetPop) {
         // humans born at end of this time step = beginning of next, hence ts1
-        uint64_t seed1 = util::master_RNG.gen_seed();
-        uint64_t seed2 = util::master_RNG.gen_seed();
+        uint64_t seed1 = SimContext::current().masterRng.gen_seed();
+        uint64_t seed2 = SimContext::current().masterRng.gen_seed();
         population.push_back( Host::Human (seed1, seed2, sim::ts1()) );
         ++cumPop;
     }
 }
 
 
+// -----  non-static methods: selection of humans  -----
+
+pair<Population::Iter, Population::Iter> Population::ageRange( SimTime minAge, SimTime maxAge ){
+    // Humans are ordered oldest to youngest, so age is non-increasing along
+    // the list. Comparing ages (not dates of birth) avoids overflow when
+    // maxAge is SimTime::future().
+    SimTime now = sim::now();
+    Iter first = std::partition_point( population.begin(), population.end(),
+        [now, maxAge]( const Host::Human& human ){ return human.age( now ) >= maxAge; } );
+    Iter last = std::partition_point( first, population.end(),
+        [now, minAge]( const Host::Human& human ){ return human.age( now ) >= minAge; } );
+    return make_pair( first, last );
+}
+
+const vector<size_t>& Population::subPopCandidates( interventions::ComponentId id ){
+    unsigned joins = SimContext::current().subPopJoinCount( id.id );
+    auto it = subPopIndex.find( id );
+    if( it != subPopIndex.end() && it->second.joins == joins ){
+        return it->second.members;
+    }
+    // Some human gained a record of membership since the list was built (or
+    // there is no list). Records expiring or being erased only make the list
+    // a superset, but new records must be seen.
+    SubPopIndex& index = subPopIndex[id];
+    index.joins = joins;
+    index.members.clear();
+    for( size_t i = 0; i < population.size(); ++i ){
+        if( population[i].hasSubPopRecord( id ) ) index.members.push_back( i );
+    }
+    return index.members;
+}
+
+
 // -----  non-static methods: reporting  -----
 
 void Population::ctsHosts (ostream& stream){
@@ -28,10 +28,14 @@
 #include <vector>
 #include <fstream>
 #include <utility>  // pair
+#include <map>
 
 namespace scnXml{
     class Scenario;
 }
+class PopulationBenchSuite;
+class VectorWarmupSampleSuite;
+class PopulationSuite;
 namespace OM {
     class Parameters;
 
@@ -65,6 +69,22 @@ public:
          necessary */
     void update( const Transmission::TransmissionModel& transmission, SimTime firstVecInitTS );
 
+    /** Replace the population by copies of a stratified sample of n humans
+     * (used for transmission fitting: see Simulator::fitTransmissionOnSample).
+     * 
+     * Strata are age bands crossed with quartiles of availability
+     * heterogeneity. Allocation is proportional, so each human of the sample
+     * stands for getSampleWeight() humans. The selection is seeded by
+     * seed1, seed2. */
+    void beginSample( size_t n, uint64_t seed1, uint64_t seed2 );
+    /// Discard the sample and restore the population set aside by beginSample()
+    void endSample();
+    /** Number of humans each human of the population stands for: one except
+     * between beginSample() and endSample(). */
+    inline double getSampleWeight() const {
+        return sampleWeight;
+    }
+
     //! Makes a survey
     void newSurvey();
     
@@ -102,8 +122,48 @@ public:
         return populationSize;
     }
     //@}
+    
+    /** Humans aged at least minAge and less than maxAge at sim::now(), as a
+     * pair of iterators (begin, end). Found by binary search, since the
+     * population is ordered by date of birth. */
+    std::pair<Iter, Iter> ageRange( SimTime minAge, SimTime maxAge );
+    
+    /** Indices (ascending) of humans which may be in sub-population id: all
+     * current members plus possibly some which have left or expired, so
+     * callers must still check Human::isInSubPop().
+     * 
+     * The list is kept across time steps (adjusted when humans are removed)
+     * and rebuilt only after some human joins the sub-population (see
+     * SimContext::joinSubPop). */
+    const vector<size_t>& subPopCandidates( interventions::ComponentId id );
 
 private:
+    /** Called after creating the first human of the initial population, with
+     * util::arena::bytesInUse() from before, to pre-allocate sub-models for
+     * the whole population. */
+    void reserveSubModels( size_t arenaUsed );
+    
+    /** Remove humans flagged by Human::remove() and out-migrate humans in
+     * excess of the target age structure, in one pass preserving order
+     * (oldest to youngest). Returns the number of humans remaining.
+     * If newIndex is given, it is set to the new index of each human, or
+     * SIZE_MAX for those removed. */
+    static int removeHumans( HumanPop& population, int targetPop,
+            vector<size_t> *newIndex = nullptr );
+    
+    /** Select a stratified sample of n of the humans with the given ages
+     * (years) and availability heterogeneity (see beginSample). Returns
+     * their indices, ascending. */
+    static vector<size_t> selectSample( const vector<double>& ages,
+            const vector<double>& het, size_t n, util::LocalRng& rng );
+    /** Set the population aside and replace it by sample (emptied), as
+     * beginSample() does after selecting and copying the sample. */
+    void swapInSample( HumanPop& sample );
+    
+    /** Adjust subPopIndex after removeHumans(), given the new index of each
+     * human (or SIZE_MAX if removed). */
+    void remapSubPopIndex( const vector<size_t>& newIndex );
+    
     /// Delegate to print the number of hosts
     void ctsHosts (ostream& stream);
     /// Delegate to print cumulative numbers of hosts under various age limits
@@ -143,7 +203,32 @@ private:
      * The list of all humans, ordered from oldest to youngest. */
     HumanPop population;
     
+    /** Candidate members of sub-populations (see subPopCandidates), with the
+     * SimContext::subPopJoinCount() at the time each list was built.
+     * Not checkpointed: rebuilt on demand. */
+    struct SubPopIndex {
+        unsigned joins;
+        vector<size_t> members;
+    };
+    std::map<interventions::ComponentId, SubPopIndex> subPopIndex;
+    /** Buffer for the new index of each human, set by removeHumans() while
+     * subPopIndex is not empty. A member so that its storage is reused each
+     * time step. Not checkpointed. */
+    vector<size_t> newIndexBuffer;
+    
+    /** While a sample is simulated (see beginSample), the full population,
+     * its size and the weight of each human of the sample (otherwise 1).
+     * Not checkpointed: sampling is started and ended between checkpoints. */
+    //@{
+    HumanPop fullPopulation;
+    size_t fullPopulationSize;
+    double sampleWeight;
+    //@}
+    
     friend class AnophelesModelSuite;
+    friend class ::PopulationBenchSuite;
+    friend class ::VectorWarmupSampleSuite;
+    friend class ::PopulationSuite;
 };
 
 }
@@ -0,0 +1,60 @@
+/* This file is part of OpenMalaria.
+ * 
+ * Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ * Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+ * 
+ * OpenMalaria is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "SimContext.h"
+#include "mon/info.h"
+
+namespace OM {
+
+SimClock::SimClock() :
+    t0( SimTime::zero() ), t1( SimTime::zero() ),
+    interv( SimTime::never() )  // large negative number
+#ifndef NDEBUG
+    , in_update( false )
+#endif
+{}
+
+SimContext::SimContext() :
+    masterRng( 0, 0 ),
+    tsAdultEntoInocs( 0.0 ), tsNumAdults( 0 ),
+    neonatalRisk( 0.0 ),
+    nextTimed( 0 ),
+    monIsInit( false ), monSurveyIndex( 0 ),
+    monSurvNumEvent( mon::NOT_USED ), monSurvNumStat( mon::NOT_USED ),
+    monNextSurveyDate( SimDate::future() )
+{
+    for( std::atomic<unsigned>& count : subPopJoins ) count = 0;
+}
+
+namespace {
+    // Context used by a process running a single simulation
+    SimContext defaultContext;
+}
+
+// Both are constant-initialised, so are valid during static initialisation
+thread_local SimContext *SimContext::s_current = &defaultContext;
+thread_local SimClock *sim::s_clock = &defaultContext.clock;
+
+void SimContext::bind( SimContext& ctx ){
+    s_current = &ctx;
+    sim::s_clock = &ctx.clock;
+}
+
+}
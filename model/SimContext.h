@@ -0,0 +1,142 @@
+/* This file is part of OpenMalaria.
+ * 
+ * Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ * Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+ * 
+ * OpenMalaria is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef Hmod_SimContext
+#define Hmod_SimContext
+
+#include "Global.h"
+#include "util/random.h"
+#include <vector>
+#include <atomic>
+#include <memory>
+
+namespace OM {
+namespace mon {
+    class Reports;
+    /// Deletes Reports (defined in mon/mon.cpp, where the type is complete)
+    struct ReportsDeleter {
+        void operator()( Reports *reports ) const;
+    };
+}
+
+/** Mutable state of one simulation which would otherwise be process-wide.
+ * 
+ * Code reads the context bound to the calling thread (see Bind), for the
+ * clock via the sim class. A default context is bound on every thread, so a
+ * process running a single simulation need not do anything;
+ * util::parallel::forChunks() binds the caller's context on worker threads.
+ * 
+ * Data initialised from the scenario and not changed afterwards (parameters,
+ * tables, the monitoring configuration, the intervention deployment lists)
+ * stays static and is shared by all contexts, which therefore all run the
+ * same scenario.
+ * 
+ * Only one context may be stepped at a time per process (as
+ * Simulator::fitTransmissionOnSample alternates between two): continuous
+ * output (mon::Continuous) is still process-wide, and util::arena, from
+ * which sub-models are allocated, is not thread-safe. */
+class SimContext {
+public:
+    SimContext();
+    
+    /// Simulation time (accessed via sim)
+    SimClock clock;
+    
+    /// The master RNG, used only for seeding local RNGs
+    util::MasterRng masterRng;
+    
+    /// Sum of EIR and number of adults requesting EIR over the current
+    /// time step (TransmissionModel)
+    double tsAdultEntoInocs;
+    int tsNumAdults;
+    
+    /// Risk of neonatal death due to maternal infection and prevalence in
+    /// potential mothers over the last five months (NeonatalMortality)
+    double neonatalRisk;
+    std::vector<double> neonatalPrev;
+    
+    /// Infant deaths and infant-intervals at risk by age in time steps
+    /// (InfantMortality; sized on first use)
+    std::vector<int> infantDeaths, infantIntervalsAtRisk;
+    
+    /// Index of the next timed intervention to deploy (InterventionManager)
+    uint32_t nextTimed;
+    
+    /// Survey progress (mon; see mon/info.h): whether the main simulation
+    /// has started, the index of the next survey, the survey numbers
+    /// reports are made to and the date of the next survey
+    //@{
+    bool monIsInit;
+    size_t monSurveyIndex;
+    size_t monSurvNumEvent, monSurvNumStat;
+    SimDate monNextSurveyDate;
+    //@}
+    
+    /// Values reported to mon and the state of conditions (allocated on first use)
+    std::unique_ptr<mon::Reports, mon::ReportsDeleter> monReports;
+    
+    /** Count humans gaining a record of membership of sub-population id
+     * (Human::reportDeployment), used to tell when
+     * Population::subPopCandidates() must be rebuilt. Counts are kept per
+     * id modulo N_SUBPOP_JOINS; sharing a count only causes extra rebuilds.
+     * joinSubPop may be called from several threads. */
+    //@{
+    inline void joinSubPop( size_t id ){
+        subPopJoins[id % N_SUBPOP_JOINS].fetch_add( 1, std::memory_order_relaxed );
+    }
+    inline unsigned subPopJoinCount( size_t id ) const{
+        return subPopJoins[id % N_SUBPOP_JOINS].load( std::memory_order_relaxed );
+    }
+    //@}
+    
+    /// The context bound to the calling thread
+    static inline SimContext& current(){ return *s_current; }
+    
+    /// Bind ctx to the calling thread
+    static void bind( SimContext& ctx );
+    
+    /** Bind a context to the calling thread for the lifetime of this
+     * object, then restore the previous binding. */
+    class Bind {
+    public:
+        explicit Bind( SimContext& ctx ) : previous( s_current ) {
+            bind( ctx );
+        }
+        ~Bind() {
+            bind( *previous );
+        }
+    private:
+        Bind( const Bind& ) = delete;
+        Bind& operator=( const Bind& ) = delete;
+        SimContext *previous;
+    };
+    
+private:
+    static const size_t N_SUBPOP_JOINS = 64;
+    std::atomic<unsigned> subPopJoins[N_SUBPOP_JOINS];
+    
+    SimContext( const SimContext& ) = delete;
+    SimContext& operator=( const SimContext& ) = delete;
+    
+    static thread_local SimContext *s_current;
+};
+
+}
+#endif
@@ -25,6 +25,7 @@
 #include "Parameters.h"
 #include "Clinical/ClinicalModel.h"
 #include "mon/Continuous.h"
+#include "SimContext.h"
 #include "interventions/InterventionManager.hpp"
 #include "Population.h"
 #include "WithinHost/WHInterface.h"
@@ -37,11 +38,22 @@
 #include "util/errors.h"
 #include "util/random.h"
 #include "util/StreamValidator.h"
+#include "util/DocumentLoader.h"
+#include "util/parallel.h"
 #include "schema/scenario.h"
 
 #include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <map>
 #include <gzstream/gzstream.h>
 #include <boost/format.hpp>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 
 
 namespace OM {
@@ -49,10 +61,6 @@ namespace OM {
     using interventions::InterventionManager;
     using Transmission::TransmissionModel;
 
-namespace util {
-    MasterRng master_RNG(0, 0);
-}
-
 bool Simulator::startedFromCheckpoint;  // static
 
 const char* CHECKPOINT = "checkpoint";
@@ -82,7 +90,7 @@ enum Phase {
 // ———  Set-up & tear-down  ———
 
 Simulator::Simulator( const scnXml::Scenario& scenario ) :
-    phase(STARTING_PHASE)
+    phase(STARTING_PHASE), warmupKey(0), showProgress(true)
 {
     // ———  Initialise static data  ———
     
@@ -95,7 +103,7 @@ Simulator::Simulator( const scnXml::Scenario& scenario ) :
     
     // The master RNG is cryptographic with a hard-coded IV. Use of low
     // Hamming weight inputs (numbers close to 0) should not reduce quality.
-    util::master_RNG.seed( model.getParameters().getIseed(), 0 );
+    SimContext::current().masterRng.seed( model.getParameters().getIseed(), 0 );
     
     util::ModelOptions::init( model.getModelOptions() );
     
@@ -116,8 +124,8 @@ Simulator::Simulator( const scnXml::Scenario& scenario ) :
     // Note: PerHost dependency can be postponed; it is only used to set adultAge
     population = unique_ptr<Population>(
             new Population( scenario.getDemography().getPopSize() ));
-    uint64_t seed1 = util::master_RNG.gen_seed();
-    uint64_t seed2 = util::master_RNG.gen_seed();
+    uint64_t seed1 = SimContext::current().masterRng.gen_seed();
+    uint64_t seed2 = SimContext::current().masterRng.gen_seed();
     transmission = unique_ptr<TransmissionModel>(
         TransmissionModel::createTransmissionModel(
             seed1, seed2,
@@ -140,12 +148,18 @@ Simulator::Simulator( const scnXml::Scenario& scenario ) :
     startedFromCheckpoint = checkpointFile.is_open();
 }
 
+Simulator::~Simulator() {
+    // don't leave a checkpoint half-written (errors are ignored here)
+    if( checkpointThread.joinable() )
+        checkpointThread.join();
+}
+
 
 // ———  run simulations  ———
 
 void Simulator::start(const scnXml::Monitoring& monitoring){
-    sim::s_t0 = SimTime::zero();
-    sim::s_t1 = SimTime::zero();
+    sim::s_clock->t0 = SimTime::zero();
+    sim::s_clock->t1 = SimTime::zero();
     
     // Make sure warmup period is at least as long as a human lifespan, as the
     // length required by vector warmup, and is a whole number of years.
@@ -173,18 +187,22 @@ void Simulator::start(const scnXml::Monitoring& monitoring){
         readCheckpoint();
     } else {
         Continuous.init( monitoring, false );
-        population->createInitialHumans();
-        transmission->init2(*population);
+        if( !readWarmupSnapshot( monitoring ) ){
+            population->createInitialHumans();
+            transmission->init2(*population);
+        }
     }
     
     int lastPercent = -1;	// last _integer_ percentage value
+    lastCheckpoint = sim::now();
+    lastCheckpointClock = chrono::steady_clock::now();
     
     // phase loop
     while (true){
         // loop for steps within a phase
         while (sim::now() < m_phaseEnd){
             int percent = (sim::now() * 100) / m_estimatedEnd;
-            if( percent != lastPercent ){	// avoid huge amounts of output for performance/log-file size reasons
+            if( percent != lastPercent && showProgress ){	// avoid huge amounts of output for performance/log-file size reasons
                 lastPercent = percent;
                 // \r cleans line. Then we print progress as a percentage.
                 cerr << (boost::format("\r[%|3i|%%]\t") %percent) << flush;
@@ -217,9 +235,20 @@ void Simulator::start(const scnXml::Monitoring& monitoring){
             transmission->update(*population);
             
             sim::end_update();
+            
+            if( phase == MAIN_PHASE && sim::now() < m_phaseEnd && periodicCheckpointDue() ){
+                writeCheckpoint( true );
+            }
         }
         
         ++phase;        // advance to next phase
+        if (phase == MAIN_PHASE && !warmupFile.empty()) {
+            writeWarmupSnapshot();
+        }
+        if (phase == MAIN_PHASE && !branchDocs.empty()) {
+            forkBranches();
+        }
+        
         if (phase == ONE_LIFE_SPAN) {
             // Start human warm-up
             m_phaseEnd = humanWarmupLength;
@@ -227,6 +256,9 @@ void Simulator::start(const scnXml::Monitoring& monitoring){
         } else if (phase == TRANSMISSION_INIT) {
             // Start or continuation of transmission init cycle (after one life span)
             SimTime iterate = transmission->initIterate();
+            if( util::CommandLine::getVectorWarmupSample() > 0 ){
+                iterate = fitTransmissionOnSample( iterate, humanWarmupLength );
+            }
             if( iterate > SimTime::zero() ){
                 m_phaseEnd += iterate;
                 --phase;        // repeat phase
@@ -241,10 +273,12 @@ void Simulator::start(const scnXml::Monitoring& monitoring){
         } else if (phase == MAIN_PHASE) {
             // Start MAIN_PHASE:
             m_phaseEnd = m_estimatedEnd;
-            sim::s_interv = SimTime::zero();
+            sim::s_clock->interv = SimTime::zero();
             population->preMainSimInit();
             transmission->summarize();    // Only to reset TransmissionModel::inoculationsPerAgeGroup
             mon::initMainSim();
+            lastCheckpoint = sim::now();
+            lastCheckpointClock = chrono::steady_clock::now();
             
         } else if (phase == END_SIM) {
             cerr << "sim end" << endl;
@@ -252,7 +286,7 @@ void Simulator::start(const scnXml::Monitoring& monitoring){
         }
         
         if (phase == MAIN_PHASE && util::CommandLine::option (util::CommandLine::CHECKPOINT)){
-            writeCheckpoint();
+            writeCheckpoint( false );
             if( util::CommandLine::option (util::CommandLine::CHECKPOINT_STOP) ){
                 throw util::cmd_exception ("Checkpoint test: checkpoint written", util::Error::None);
             }
@@ -260,9 +294,12 @@ void Simulator::start(const scnXml::Monitoring& monitoring){
     }
     
     cerr << '\r' << flush;	// clean last line of progress-output
+    waitCheckpoint();
+    Continuous.sync();
     
     population->flushReports();        // ensure all Human instances report past events
     mon::writeSurveyData();
+    waitBranches();
     
 # ifdef OM_STREAM_VALIDATOR
     util::StreamValidator.saveStream();
@@ -270,6 +307,377 @@ void Simulator::start(const scnXml::Monitoring& monitoring){
 }
 
 
+// ———  checkpoint files  ———
+
+/* Checkpoints and warm-up snapshots are gzip-compressed unless
+ * --checkpoint-compression none is given. The data written is the same
+ * either way; uncompressed files are larger but much faster to write and
+ * read (compression dominates the cost). */
+bool compressCheckpoints(){
+    return !util::CommandLine::option( util::CommandLine::CHECKPOINT_UNCOMPRESSED );
+}
+/// File name extension for checkpoint files
+const char* checkpointExtension(){
+    return compressCheckpoints() ? ".gz" : "";
+}
+
+/// Call write(stream) on a new file called name
+template<class F>
+void writeCheckpointFile( const string& name, F write ){
+    if( compressCheckpoints() ){
+        ogzstream out(name.c_str(), ios::out | ios::binary);
+        write (out);
+        out.close();
+        if( !out )
+            throw util::checkpoint_error ("error writing " + name);
+    }else{
+        ofstream out(name.c_str(), ios::out | ios::binary);
+        write (out);
+        out.close();
+        if( !out )
+            throw util::checkpoint_error ("error writing " + name);
+    }
+}
+
+/// True if file name starts with the gzip magic bytes
+bool isGzipFile( const string& name ){
+    ifstream in(name.c_str(), ios::in | ios::binary);
+    char magic[2];
+    return in.read( magic, 2 ) && magic[0] == '\x1f' && magic[1] == '\x8b';
+}
+
+/** Throw if file name exists but was written with the other compression
+ * setting (it would otherwise fail with an unhelpful read error). */
+void checkCompression( const string& name ){
+    if( !ifstream(name.c_str()).is_open() )
+        return;
+    bool gzip = isGzipFile( name );
+    if( gzip != compressCheckpoints() ){
+        throw util::checkpoint_error( name + (gzip ?
+            " is gzip-compressed; use --checkpoint-compression gzip" :
+            " is not compressed; use --checkpoint-compression none") );
+    }
+}
+
+/// Call read(stream) on file name, returning false if it cannot be opened
+template<class F>
+bool readCheckpointFile( const string& name, F read ){
+    checkCompression( name );
+    if( compressCheckpoints() ){
+        igzstream in(name.c_str(), ios::in | ios::binary);
+        //Note: gzstreams are considered "good" when file not open!
+        if ( !( in.good() && in.rdbuf()->is_open() ) )
+            return false;
+        read (in);
+        in.close();
+    }else{
+        ifstream in(name.c_str(), ios::in | ios::binary);
+        if( !in.is_open() )
+            return false;
+        read (in);
+    }
+    return true;
+}
+
+
+// ———  warm-up snapshots  ———
+
+SimTime Simulator::fitTransmissionOnSample( SimTime iterate, SimTime humanWarmupLength ){
+    if( !transmission->inFittingRound() ) return iterate;
+    
+    size_t sampleSize = util::CommandLine::getVectorWarmupSample();
+    if( sampleSize >= population->size() ) return iterate;     // nothing to save
+    
+    // The sample continues from the current state on a context of its own
+    SimContext sample;
+    const SimContext& main = SimContext::current();
+    sample.clock = main.clock;
+    sample.tsAdultEntoInocs = main.tsAdultEntoInocs;
+    sample.tsNumAdults = main.tsNumAdults;
+    sample.neonatalRisk = main.neonatalRisk;
+    sample.neonatalPrev = main.neonatalPrev;
+    uint64_t seed1 = SimContext::current().masterRng.gen_seed();
+    uint64_t seed2 = SimContext::current().masterRng.gen_seed();
+    sample.masterRng.seed( seed1, seed2 );
+    
+    seed1 = sample.masterRng.gen_seed();
+    seed2 = sample.masterRng.gen_seed();
+    population->beginSample( sampleSize, seed1, seed2 );
+    {
+        SimContext::Bind bind( sample );
+        // Steps as in start(), without monitoring and interventions (which
+        // do nothing before the main phase)
+        while( iterate > SimTime::zero() && transmission->inFittingRound() ){
+            const SimTime end = sim::now() + iterate;
+            while( sim::now() < end ){
+                sim::start_update();
+                transmission->vectorUpdate (*population);
+                population->update(*transmission, humanWarmupLength);
+                transmission->update(*population);
+                sim::end_update();
+            }
+            iterate = transmission->initIterate();
+        }
+    }
+    population->endSample();
+    // The vector state was advanced on the sample's clock; the full
+    // population continues from the time on the main clock
+    transmission->shiftTime( sample.clock.t1 - main.clock.t1 );
+    return iterate;
+}
+
+void Simulator::useWarmupCache( uint64_t hash ){
+    warmupKey = hash;
+    ostringstream name;
+    name << util::CommandLine::getWarmupCacheDir() << "/warmup-"
+        << hex << setfill('0') << setw(16) << hash;
+    // Command-line options affecting the warm-up:
+    if( util::CommandLine::option( util::CommandLine::DRUG_INTEGRATION_GL ) )
+        name << "-gl";
+    if( util::CommandLine::option( util::CommandLine::FAST_VECTOR_WARMUP ) ){
+        name << "-fv";
+        // checked by classic fitting rounds, which change the fit:
+        if( util::CommandLine::option( util::CommandLine::DEBUG_VECTOR_FITTING ) )
+            name << "c";
+    }
+    if( util::CommandLine::getVectorWarmupSample() > 0 )
+        name << "-vs" << dec << util::CommandLine::getVectorWarmupSample();
+    name << checkpointExtension();
+    warmupFile = name.str();
+}
+
+bool Simulator::readWarmupSnapshot(const scnXml::Monitoring& monitoring){
+    if( warmupFile.empty() ) return false;
+    
+    // Continuous output during the warm-up and the stream validator need
+    // the warm-up to be simulated.
+#   ifdef OM_STREAM_VALIDATOR
+    cerr << "Warning: warm-up cache is not supported with OM_STREAM_VALIDATOR" << endl;
+    warmupFile.clear();
+    return false;
+#   endif
+    if( monitoring.getContinuous().present() &&
+        monitoring.getContinuous().get().getDuringInit().present() &&
+        monitoring.getContinuous().get().getDuringInit().get() )
+    {
+        cerr << "Warning: warm-up cache not used since continuous output "
+            "during initialisation is enabled" << endl;
+        warmupFile.clear();
+        return false;
+    }
+    
+    if( !readCheckpointFile( warmupFile,
+            [this]( istream& in ){ warmupSnapshot (in); } ) )
+        return false;   // no snapshot yet: simulate warm-up and write one
+    warmupFile.clear();     // don't write it again
+    
+    // Continue as if the last transmission-init period just finished:
+    phase = TRANSMISSION_INIT;
+    m_phaseEnd = sim::now();
+    m_estimatedEnd = sim::now()
+        + (sim::endDate() - sim::startDate())
+        + SimTime::oneTS();
+    cerr << sim::now().inSteps() << "t loaded warm-up snapshot" << endl;
+    return true;
+}
+
+void Simulator::writeWarmupSnapshot(){
+    // Write to a temporary file, then rename, so that other simulations
+    // sharing the cache never read a partially-written snapshot.
+    ostringstream tmpName;
+    tmpName << warmupFile << ".tmp"
+        << chrono::steady_clock::now().time_since_epoch().count();
+    writeCheckpointFile( tmpName.str(),
+            [this]( ostream& out ){ warmupSnapshot (out); } );
+    if( rename( tmpName.str().c_str(), warmupFile.c_str() ) != 0 ){
+        remove( tmpName.str().c_str() );
+        throw util::checkpoint_error ("unable to write warm-up snapshot " + warmupFile);
+    }
+    warmupFile.clear();
+}
+
+void Simulator::warmupSnapshot (istream& stream) {
+    try {
+        util::checkpoint::header (stream);
+        uint64_t key;
+        key & stream;
+        if( key != warmupKey )
+            throw util::checkpoint_error ("warm-up snapshot is for a different scenario");
+        Population::staticCheckpoint (stream);
+        transmission & stream;
+        population->checkpoint(stream);
+        
+        sim::s_clock->t0 & stream;
+        sim::s_clock->t1 & stream;
+        SimContext::current().masterRng.checkpoint(stream);
+    } catch (const util::checkpoint_error& e) {
+        throw util::checkpoint_error( warmupFile + ": " + e.what() );
+    }
+    
+    stream.ignore (numeric_limits<streamsize>::max()-1);        // skip to end of file
+    if (stream.gcount () != 0 || stream.fail())
+        throw util::checkpoint_error (warmupFile + ": unexpected data at end of warm-up snapshot");
+}
+
+void Simulator::warmupSnapshot (ostream& stream) {
+    util::checkpoint::header (stream);
+    if (!stream.good())
+        throw util::checkpoint_error ("Unable to write to file");
+    
+    warmupKey & stream;
+    Population::staticCheckpoint (stream);
+    transmission & stream;
+    population->checkpoint(stream);
+    
+    sim::s_clock->t0 & stream;
+    sim::s_clock->t1 & stream;
+    SimContext::current().masterRng.checkpoint(stream);
+}
+
+
+// ———  branches  ———
+
+void Simulator::useBranches( uint64_t hash ){
+    const vector<string>& names = util::CommandLine::getBranches();
+    for( size_t i = 0; i < names.size(); ++i ){
+        string file = util::CommandLine::getBranchScenario( i );
+        unique_ptr<util::DocumentLoader> doc( new util::DocumentLoader );
+        doc->loadDocument( file );
+        if( doc->warmupHash() != hash ){
+            throw util::xml_scenario_error( "branch " + names[i] + ": " + file +
+                " differs from this scenario in elements other than human"
+                " interventions, changeHS, changeEIR, importedInfections and surveys" );
+        }
+        branchDocs.push_back( move(doc) );
+    }
+}
+
+void Simulator::forkBranches(){
+#ifndef _WIN32
+    // Worker threads are not copied by fork(); stop them (they restart on
+    // next use).
+    size_t nThreads = util::parallel::numThreads();
+    util::parallel::setNumThreads( 1 );
+    Continuous.sync();
+    cout << flush;
+    
+    for( size_t i = 0; i < branchDocs.size(); ++i ){
+        pid_t pid = fork();
+        if( pid < 0 ){
+            throw util::base_exception( "unable to fork branch " +
+                util::CommandLine::getBranches()[i] );
+        }
+        if( pid == 0 ){
+            // Child: become branch i
+            branchDoc = move( branchDocs[i] );
+            branchDocs.clear();
+            branchPids.clear();
+            showProgress = false;
+            
+            const scnXml::Scenario& scenario = branchDoc->document();
+            InterventionManager::initBranch( scenario.getInterventions() );
+            mon::initCohorts( scenario.getMonitoring() );
+            util::CommandLine::selectBranch( i );
+            Continuous.redirect( util::CommandLine::getCtsoutName() );
+            break;
+        }
+        branchPids.push_back( pid );
+    }
+    branchDocs.clear();
+    
+    util::parallel::setNumThreads( nThreads );
+#endif
+}
+
+void Simulator::waitBranches(){
+#ifndef _WIN32
+    const vector<string>& names = util::CommandLine::getBranches();
+    size_t failed = 0;
+    for( size_t i = 0; i < branchPids.size(); ++i ){
+        int status = 0;
+        if( waitpid( branchPids[i], &status, 0 ) < 0 ||
+            !WIFEXITED(status) || WEXITSTATUS(status) != 0 )
+        {
+            cerr << "Branch " << names[i] << " failed" << endl;
+            ++failed;
+        }
+    }
+    branchPids.clear();
+    if( failed > 0 ){
+        ostringstream msg;
+        msg << failed << " of " << names.size() << " branches failed";
+        throw util::base_exception( msg.str() );
+    }
+#endif
+}
+
+
+// ———  ensembles  ———
+
+void Simulator::reseed( uint64_t seed ){
+    // As in the constructor:
+    SimContext::current().masterRng.seed( seed, 0 );
+    uint64_t seed1 = SimContext::current().masterRng.gen_seed();
+    uint64_t seed2 = SimContext::current().masterRng.gen_seed();
+    transmission->reseed( seed1, seed2 );
+}
+
+void Simulator::runEnsemble(const scnXml::Monitoring& monitoring){
+#ifndef _WIN32
+    const vector<uint64_t>& seeds = util::CommandLine::getSeeds();
+    const size_t numJobs = util::CommandLine::getNumJobs();
+    // Worker threads are not copied by fork(); stop them (they restart on
+    // next use).
+    size_t nThreads = util::parallel::numThreads();
+    util::parallel::setNumThreads( 1 );
+    cout << flush;
+    
+    map<pid_t, uint64_t> running;
+    size_t next = 0, done = 0, failed = 0;
+    while( next < seeds.size() || !running.empty() ){
+        if( next < seeds.size() && running.size() < numJobs ){
+            pid_t pid = fork();
+            if( pid < 0 ){
+                throw util::base_exception( "unable to fork ensemble replicate" );
+            }
+            if( pid == 0 ){
+                // Child: run replicate
+                util::parallel::setNumThreads( nThreads );
+                util::CommandLine::selectSeed( seeds[next] );
+                reseed( seeds[next] );
+                showProgress = false;
+                start( monitoring );
+                return;
+            }
+            running[pid] = seeds[next];
+            ++next;
+        }else{
+            int status = 0;
+            pid_t pid = waitpid( -1, &status, 0 );
+            if( pid < 0 )
+                throw util::base_exception( "waiting for ensemble replicates failed" );
+            auto it = running.find( pid );
+            if( it == running.end() ) continue;
+            ++done;
+            if( !WIFEXITED(status) || WEXITSTATUS(status) != 0 ){
+                cerr << "\rReplicate with seed " << it->second << " failed" << endl;
+                ++failed;
+            }
+            running.erase( it );
+            cerr << '\r' << done << " of " << seeds.size() << " replicates done" << flush;
+        }
+    }
+    cerr << endl;
+    util::parallel::setNumThreads( nThreads );
+    if( failed > 0 ){
+        ostringstream msg;
+        msg << failed << " of " << seeds.size() << " replicates failed";
+        throw util::base_exception( msg.str() );
+    }
+#endif
+}
+
+
 // ———  checkpointing: set up read/write stream  ———
 
 int readCheckpointNum () {
@@ -283,42 +691,92 @@ int readCheckpointNum () {
     return checkpointNum;
 }
 
-void Simulator::writeCheckpoint(){
-    // We alternate between two checkpoints, in case program is closed while writing.
-    const int NUM_CHECKPOINTS = 2;
-    
-    int oldCheckpointNum = 0, checkpointNum = 0;
-    if (isCheckpoint()) {
-        oldCheckpointNum = readCheckpointNum();
-        // Get next checkpoint number:
-        checkpointNum = mod_nn(oldCheckpointNum + 1, NUM_CHECKPOINTS);
-    }
-    
+/** Write serialised checkpoint data to checkpoint file number num, then
+ * mark it as the latest and truncate file oldNum. */
+void writeCheckpointFiles( const string& data, int num, int oldNum ){
     {   // Open the next checkpoint file for writing:
         ostringstream name;
-        name << CHECKPOINT << checkpointNum << ".gz";
+        name << CHECKPOINT << num << checkpointExtension();
         //Writing checkpoint:
-        ogzstream out(name.str().c_str(), ios::out | ios::binary);
-        checkpoint (out);
-        out.close();
+        writeCheckpointFile( name.str(), [&data]( ostream& out ){
+            out.write( data.data(), data.size() ); } );
     }
     
     {   // Indicate which is the latest checkpoint file.
         ofstream checkpointFile;
         checkpointFile.open(CHECKPOINT,ios::out);
-        checkpointFile << checkpointNum;
+        checkpointFile << num;
         checkpointFile.close();
         if (!checkpointFile)
             throw util::checkpoint_error ("error writing to file \"checkpoint\"");
     }
     // Truncate the old checkpoint to save disk space, when it existed
-    if( oldCheckpointNum != checkpointNum ){
+    if( oldNum != num ){
         ostringstream name;
-        name << CHECKPOINT << oldCheckpointNum << ".gz";
+        name << CHECKPOINT << oldNum << checkpointExtension();
         ofstream out(name.str().c_str(), ios::out | ios::binary);
         out.close();
     }
-//     cerr << " OK" << endl;
+}
+
+void Simulator::writeCheckpoint( bool background ){
+    // Only one checkpoint is written at a time. Waiting also makes sure the
+    // file "checkpoint" is up to date.
+    waitCheckpoint();
+    
+    // We alternate between two checkpoints, in case program is closed while writing.
+    const int NUM_CHECKPOINTS = 2;
+    
+    int oldCheckpointNum = 0, checkpointNum = 0;
+    if (ifstream(CHECKPOINT).is_open()) {       // resumed or written before
+        oldCheckpointNum = readCheckpointNum();
+        // Get next checkpoint number:
+        checkpointNum = mod_nn(oldCheckpointNum + 1, NUM_CHECKPOINTS);
+    }
+    
+    // Serialise now, before the state changes; this is fast compared to
+    // compression and output.
+    shared_ptr<string> data = make_shared<string>();
+    {
+        ostringstream buf( ios::out | ios::binary );
+        checkpoint (buf);
+        *data = buf.str();
+    }
+    lastCheckpoint = sim::now();
+    lastCheckpointClock = chrono::steady_clock::now();
+    
+    if( background ){
+        checkpointThread = thread( [this, data, checkpointNum, oldCheckpointNum](){
+            try{
+                writeCheckpointFiles( *data, checkpointNum, oldCheckpointNum );
+            }catch( ... ){
+                checkpointError = current_exception();
+            }
+        } );
+    }else{
+        writeCheckpointFiles( *data, checkpointNum, oldCheckpointNum );
+    }
+}
+
+void Simulator::waitCheckpoint(){
+    if( checkpointThread.joinable() )
+        checkpointThread.join();
+    if( checkpointError ){
+        exception_ptr e = checkpointError;
+        checkpointError = exception_ptr();
+        rethrow_exception( e );
+    }
+}
+
+bool Simulator::periodicCheckpointDue() const{
+    size_t steps = util::CommandLine::getCheckpointSteps();
+    if( steps > 0 && (sim::now() - lastCheckpoint).inSteps() >= static_cast<int>(steps) )
+        return true;
+    double minutes = util::CommandLine::getCheckpointMinutes();
+    if( minutes > 0.0 && chrono::duration<double>(
+            chrono::steady_clock::now() - lastCheckpointClock ).count() >= minutes * 60.0 )
+        return true;
+    return false;
 }
 
 void Simulator::readCheckpoint() {
@@ -326,13 +784,17 @@ void Simulator::readCheckpoint() {
     
     // Open the latest file
     ostringstream name;
-    name << CHECKPOINT << checkpointNum << ".gz";
-    igzstream in(name.str().c_str(), ios::in | ios::binary);
-    //Note: gzstreams are considered "good" when file not open!
-    if ( !( in.good() && in.rdbuf()->is_open() ) )
-        throw util::checkpoint_error ("Unable to read file");
-    checkpoint (in);
-    in.close();
+    name << CHECKPOINT << checkpointNum << checkpointExtension();
+    if( !readCheckpointFile( name.str(),
+            [this]( istream& in ){ checkpoint (in); } ) )
+    {
+        // The checkpoint may have been written with the other setting of
+        // --checkpoint-compression (which changes the file name)
+        ostringstream other;
+        other << CHECKPOINT << checkpointNum << (compressCheckpoints() ? "" : ".gz");
+        checkCompression( other.str() );
+        throw util::checkpoint_error ("Unable to read file " + name.str());
+    }
   
     cerr << sim::now().inSteps() << "t loaded checkpoint" << endl;
 }
@@ -351,7 +813,7 @@ void Simulator::checkpoint (istream& stream) {
         util::StreamValidator & stream;
 #       endif
         
-        sim::s_interv & stream;
+        sim::s_clock->interv & stream;
         m_phaseEnd & stream;
         m_estimatedEnd & stream;
         phase & stream;
@@ -362,9 +824,9 @@ void Simulator::checkpoint (istream& stream) {
         
         // read last, because other loads may use random numbers or expect time
         // to be negative
-        sim::s_t0 & stream;
-        sim::s_t1 & stream;
-        util::master_RNG.checkpoint(stream);
+        sim::s_clock->t0 & stream;
+        sim::s_clock->t1 & stream;
+        SimContext::current().masterRng.checkpoint(stream);
     } catch (const util::checkpoint_error& e) { // append " (pos X of Y bytes)"
         ostringstream pos;
         pos<<" (pos "<<stream.tellg()<<" of ";
@@ -397,7 +859,7 @@ void Simulator::checkpoint (ostream& stream) {
     util::StreamValidator & stream;
 # endif
     
-    sim::s_interv & stream;
+    sim::s_clock->interv & stream;
     m_phaseEnd & stream;
     m_estimatedEnd & stream;
     phase & stream;
@@ -405,9 +867,9 @@ void Simulator::checkpoint (ostream& stream) {
     population->checkpoint(stream);
     InterventionManager::checkpoint( stream );
     
-    sim::s_t0 & stream;
-    sim::s_t1 & stream;
-    util::master_RNG.checkpoint(stream);
+    sim::s_clock->t0 & stream;
+    sim::s_clock->t1 & stream;
+    SimContext::current().masterRng.checkpoint(stream);
     
     util::timer::stopCheckpoint ();
     if (stream.fail())
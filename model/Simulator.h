@@ -24,6 +24,9 @@
 #include "Global.h"
 #include "Population.h"
 #include "Transmission/TransmissionModel.h"
+#include <thread>
+#include <chrono>
+#include <exception>
 using namespace std;
 
 namespace scnXml{
@@ -31,16 +34,47 @@ namespace scnXml{
     class Scenario;
 }
 namespace OM {
+namespace util {
+    class DocumentLoader;
+}
     
 //! Main simulation class
 class Simulator{
 public: 
     //!  Inititalise all step specific constants and variables.
     Simulator( const scnXml::Scenario& scenario );
+    ~Simulator();
     
     //! Entry point to simulation.
     void start(const scnXml::Monitoring& monitoring);
     
+    /** Use a warm-up snapshot cache (see --warmup-cache).
+     * 
+     * If the cache holds a snapshot for this hash, start() loads it and skips
+     * the warm-up; otherwise start() stores a snapshot when the main phase
+     * is reached.
+     * 
+     * @param hash Hash of scenario excluding intervention-period elements
+     *  (see util::DocumentLoader::warmupHash()) */
+    void useWarmupCache( uint64_t hash );
+    
+    /** Run branches (see --branch): load and check their scenarios now,
+     * and fork a process for each when the main phase starts.
+     * 
+     * @param hash Hash of this scenario excluding intervention-period
+     *  elements; branch scenarios must have the same hash */
+    void useBranches( uint64_t hash );
+    
+    /** Run an ensemble (see --seeds): one replicate per seed, each in a
+     * process forked from this one (after initialisation, so that the
+     * scenario is loaded and static data initialised only once), running up
+     * to --jobs at once. Each replicate gives the same results as a separate
+     * run of the scenario with its seed.
+     * 
+     * Returns in the parent once all replicates finished (throwing if any
+     * failed), and in each replicate once its simulation finished. */
+    void runEnsemble(const scnXml::Monitoring& monitoring);
+    
     /// Return true when this simulation started by loading a checkpoint
     inline static bool isCheckpoint(){ return startedFromCheckpoint; }
     
@@ -50,18 +84,82 @@ private:
     * readCheckpoint/writeCheckpoint prepare to read/write the file,
     * and read/write read and write the actual data. */
     //@{
-    void writeCheckpoint();
+    /** Write a checkpoint. The state is serialised immediately; if
+     * background is true, compression and file output happen on another
+     * thread while the simulation continues (see waitCheckpoint()). */
+    void writeCheckpoint( bool background );
+    /** Wait for a checkpoint being written in the background, if any, and
+     * rethrow any error from writing it. */
+    void waitCheckpoint();
+    /// True when a periodic checkpoint (--checkpoint-steps/minutes) is due
+    bool periodicCheckpointDue() const;
     void readCheckpoint();
     
     void checkpoint (istream& stream);
     void checkpoint (ostream& stream);
     //@}
     
+    /** @brief Warm-up snapshots
+     * 
+     * A subset of a checkpoint: the state at the start of the main phase,
+     * excluding monitoring and interventions (which have no state until the
+     * main phase starts). */
+    //@{
+    void writeWarmupSnapshot();
+    /// Load a snapshot if available; return true if loaded
+    bool readWarmupSnapshot(const scnXml::Monitoring& monitoring);
+    
+    void warmupSnapshot (istream& stream);
+    void warmupSnapshot (ostream& stream);
+    //@}
+    
+    /** @brief Branches
+     * 
+     * forkBranches() forks one process per branch. In a child, it replaces
+     * interventions and output files with those of the branch; the parent
+     * continues with this scenario, then waitBranches() waits for children
+     * (and throws if any failed). */
+    //@{
+    void forkBranches();
+    void waitBranches();
+    //@}
+    
+    /** Run the transmission fitting rounds which remain after
+     * initIterate() returned iterate, on a stratified sample of the
+     * population (see --vector-warmup-sample) and on a clock of their own,
+     * so that neither the full population nor the simulation time changes.
+     * Returns the time requested by the last call to initIterate(), for the
+     * final stabilisation with the full population. */
+    SimTime fitTransmissionOnSample( SimTime iterate, SimTime humanWarmupLength );
+    
+    /** Use this seed in place of the scenario's; call before start(). The
+     * same random numbers are drawn as when constructing with this seed. */
+    void reseed( uint64_t seed );
+    
     // Data
     SimTime m_phaseEnd;
     SimTime m_estimatedEnd;
     int phase;  // only need be a class member because value is checkpointed
     
+    // Checkpoint being written in the background and its error, if any
+    thread checkpointThread;
+    exception_ptr checkpointError;
+    // Time of last checkpoint (or start of main phase), for periodic checkpoints
+    SimTime lastCheckpoint;
+    chrono::steady_clock::time_point lastCheckpointClock;
+    
+    // Warm-up snapshot file name and scenario hash (empty if not used)
+    string warmupFile;
+    uint64_t warmupKey;
+    
+    // Scenarios of branches still to fork, then their process ids
+    vector<unique_ptr<util::DocumentLoader>> branchDocs;
+    vector<int> branchPids;
+    // In a branch process: its scenario (otherwise null)
+    unique_ptr<util::DocumentLoader> branchDoc;
+    // False in branch and ensemble processes
+    bool showProgress;
+    
     static bool startedFromCheckpoint;
     
     friend class AnophelesModelSuite;
@@ -163,6 +163,18 @@ public:
     inline bool initIterate (){
         return transmission.emergence->initIterate(transmission);
     }
+    /// Fit factor of the last call to initIterate() (see EmergenceModel)
+    inline double fitFactor() const{
+        return transmission.emergence->fitFactor();
+    }
+    /// Fitted emergence rate per day of the year (see EmergenceModel)
+    inline const vecDay<double>& getEmergenceRate() const{
+        return transmission.emergence->getEmergenceRate();
+    }
+    /// See MosqTransmission::shiftTime
+    inline void shiftTime( SimTime offset ){
+        transmission.shiftTime( offset );
+    }
     //@}
 
     
@@ -39,6 +39,7 @@ EmergenceModel::EmergenceModel() :
             FSRotateAngle(numeric_limits<double>::quiet_NaN()),
             initNvFromSv(numeric_limits<double>::quiet_NaN()),
             initOvFromSv(numeric_limits<double>::quiet_NaN()),
+            lastFitFactor(numeric_limits<double>::quiet_NaN()),
             emergenceSurvival(1.0)
 {
     forcedS_v.resize (SimTime::oneYear());
@@ -93,6 +93,14 @@ public:
      *
      * @returns true if another iteration is needed. */
     virtual bool initIterate (MosqTransmission& transmission) =0;
+    
+    /** Ratio of the required to the simulated S_v found by the last call to
+     * initIterate() (one when fitted; NaN before the first call). */
+    inline double fitFactor() const{ return lastFitFactor; }
+    
+    /** Emergence rate for every day of the year, as fitted (units: animals
+     * per day). */
+    virtual const vecDay<double>& getEmergenceRate() const =0;
     //@}
     
     /// Update per time-step (for larviciding intervention). Call before
@@ -114,6 +122,10 @@ public:
      */
     virtual double update( SimTime d0, double nOvipositing, double S_v ) =0;
     
+    /** Re-index per-day state for a simulation continuing offset earlier
+     * than the state was computed for (see MosqTransmission::shiftTime). */
+    virtual void shiftTime( SimTime offset ) =0;
+    
     ///@brief Interventions and reporting
     //@{
     /// Start an intervention affecting the vector population.
@@ -186,6 +198,9 @@ protected:
     /** Conversion factor from forcedS_v to (initial values of) O_v (ρ_O / ρ_S).
      * Should be checkpointed. */
     double initOvFromSv;
+    
+    /// Set by initIterate() for reporting only; not checkpointed.
+    double lastFitFactor;
     //@}
     
     /** @brief Intervention parameters
@@ -73,6 +73,7 @@ bool FixedEmergence::initIterate (MosqTransmission& transmission) {
     // EIR comes directly from S_v, so should fit after we're done.
 
     double factor = vectors::sum (forcedS_v)*5 / vectors::sum(quinquennialS_v);
+    lastFitFactor = factor;
     //cout << "Pre-calced Sv, dynamic Sv:\t"<<sumAnnualForcedS_v<<'\t'<<vectors::sum(annualS_v)<<endl;
     if (!(factor > 1e-6 && factor < 1e6)) {
         if( factor > 1e6 && vectors::sum(quinquennialS_v) < 1e-3 ){
@@ -132,6 +133,11 @@ double FixedEmergence::update( SimTime d0, double nOvipositing, double S_v ){
     return mosqEmergeRate[dYear1] * interventionSurvival();
 }
 
+void FixedEmergence::shiftTime( SimTime offset ){
+    // mosqEmergeRate is per day of the year, which offset does not change
+    quinquennialS_v.rotate( mod_nn(offset, quinquennialS_v.size()) );
+}
+
 void FixedEmergence::checkpoint (istream& stream){ (*this) & stream; }
 void FixedEmergence::checkpoint (ostream& stream){ (*this) & stream; }
 
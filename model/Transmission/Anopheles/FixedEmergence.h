@@ -27,6 +27,8 @@
 #include <vector>
 #include <limits>
 
+class VectorWarmupSampleSuite;
+
 namespace OM {
 namespace Transmission {
 namespace Anopheles {
@@ -70,6 +72,11 @@ public:
     //@}
     
     virtual double update( SimTime d0, double nOvipositing, double S_v );
+    virtual void shiftTime( SimTime offset );
+    
+    virtual const vecDay<double>& getEmergenceRate() const{
+        return mosqEmergeRate;
+    }
     
     ///@brief Interventions and reporting
     //@{
@@ -125,6 +132,8 @@ private:
      *
      * Should be checkpointed. */
     vecDay<double> mosqEmergeRate;
+    
+    friend class ::VectorWarmupSampleSuite;
 };
 
 }
@@ -42,6 +42,9 @@ MosqTransmission::MosqTransmission() :
         EIPDuration(SimTime::zero()),
         N_v_length(SimTime::zero()),
         minInfectedThreshold( std::numeric_limits< double >::quiet_NaN() ),     // requires config
+        fLastDay(SimTime::never()),
+        fInputRun(SimTime::zero()),
+        fCacheValid(false),
         timeStep_N_v0(0.0)
 {
     // Warning: don't allocate memory here. The whole instance will be
@@ -102,7 +105,14 @@ void MosqTransmission::initialise ( const scnXml::AnophelesParams::LifeCycleOpti
     }
     ftauArray[mosqRestDuration] = 1.0;
     uninfected_v.resize(N_v_length);
-    uninfected_v[SimTime::zero()] = numeric_limits<double>::quiet_NaN();    // index not used
+}
+
+void MosqTransmission::updateUninfected(){
+    for( SimTime t = SimTime::zero(); t < N_v_length; t += SimTime::oneDay() ){
+        double sum = N_v[t];
+        for( size_t i = 0; i < Genotypes::N(); ++i ) sum -= O_v.at(t,i);
+        uninfected_v[t] = sum;
+    }
 }
 
 void MosqTransmission::initIterateScale ( double factor ){
@@ -111,6 +121,7 @@ void MosqTransmission::initIterateScale ( double factor ){
     // they should reach stable values quickly.
     vectors::scale (O_v, factor);
     vectors::scale (S_v, factor);
+    updateUninfected();
 }
 
 void MosqTransmission::initState ( double tsP_A, double tsP_df, double tsP_dff,
@@ -136,11 +147,13 @@ void MosqTransmission::initState ( double tsP_A, double tsP_df, double tsP_dff,
             O_v.at(t,genotype) = S_v.at(t,genotype) * initOvFromSv;
         }
     }
+    updateUninfected();
+    fLastDay = SimTime::never();        // P_A, P_df changed
 }
 
 
 void MosqTransmission::update( SimTime d0, double tsP_A, double tsP_df,
-        const vector<double> tsP_dif, double tsP_dff,
+        const vector<double>& tsP_dif, double tsP_dff,
         bool isDynamic,
         vector<double>& partialEIR, double EIR_factor )
 {
@@ -154,81 +167,126 @@ void MosqTransmission::update( SimTime d0, double tsP_A, double tsP_df,
     SimTime t0   = mod_nn(d0, N_v_length);
     SimTime ttau = mod_nn(d1Mod - mosqRestDuration, N_v_length);
     
+    const size_t nGenotypes = Genotypes::N();
+    
     // These only need to be calculated once per time step, but should be
     // present in each of the previous N_v_length - 1 positions of arrays.
     P_A[t1] = tsP_A;
     P_df[t1] = tsP_df;
     P_dff[t1] = tsP_dff;
-    for( size_t i = 0; i < Genotypes::N(); ++i )
+    for( size_t i = 0; i < nGenotypes; ++i )
         P_dif.at(t1,i) = tsP_dif[i];
     
     
-    //BEGIN cache calculation: fArray, ftauArray, uninfected_v
-    // Set up array with n in 1..θ_s−τ for f(d1Mod-n) (NDEMD eq. 1.6)
-    for( SimTime n = SimTime::oneDay(); n <= mosqRestDuration; n += SimTime::oneDay() ){
-        const SimTime tn = mod_nn(d1Mod-n, N_v_length);
-        fArray[n] = fArray[n-SimTime::oneDay()] * P_A[tn];
+    //BEGIN cache calculation: fArray, ftauArray
+    // These depend only on P_A and P_df over days d1-θ_s+1 .. d0 (n in
+    // 1..θ_s−1 below). fInputRun counts the days up to d0 over which both
+    // were unchanged. Where the current and the previous update both see
+    // only one value, the arrays from that update are still correct.
+    if( d0 != fLastDay + SimTime::oneDay() ){
+        // first update after initState, or days were skipped: count afresh
+        // (excluding t1, which was just overwritten)
+        fInputRun = SimTime::zero();
+        fCacheValid = false;
+        while( fInputRun < N_v_length - SimTime::oneDay() ){
+            const SimTime t = mod_nn(d0 + N_v_length - fInputRun, N_v_length);
+            if( P_A[t] != P_A[t0] || P_df[t] != P_df[t0] ) break;
+            fInputRun += SimTime::oneDay();
+        }
     }
-    fArray[mosqRestDuration] += P_df[ttau];
+    fLastDay = d0;
+    const bool inputsConst = fInputRun >= EIPDuration - SimTime::oneDay();
+    if( !(inputsConst && fCacheValid) ){
+        // Set up array with n in 1..θ_s−τ for f(d1Mod-n) (NDEMD eq. 1.6)
+        for( SimTime n = SimTime::oneDay(); n <= mosqRestDuration; n += SimTime::oneDay() ){
+            const SimTime tn = mod_nn(d1Mod-n, N_v_length);
+            fArray[n] = fArray[n-SimTime::oneDay()] * P_A[tn];
+        }
+        fArray[mosqRestDuration] += P_df[ttau];
     
-    const SimTime fAEnd = EIPDuration-mosqRestDuration;
-    for( SimTime n = mosqRestDuration+SimTime::oneDay(); n <= fAEnd; n += SimTime::oneDay() ){
-        const SimTime tn = mod_nn(d1Mod-n, N_v_length);
-        fArray[n] =
-            P_df[tn] * fArray[n - mosqRestDuration]
-            + P_A[tn] * fArray[n-SimTime::oneDay()];
-    }
+        const SimTime fAEnd = EIPDuration-mosqRestDuration;
+        for( SimTime n = mosqRestDuration+SimTime::oneDay(); n <= fAEnd; n += SimTime::oneDay() ){
+            const SimTime tn = mod_nn(d1Mod-n, N_v_length);
+            fArray[n] =
+                P_df[tn] * fArray[n - mosqRestDuration]
+                + P_A[tn] * fArray[n-SimTime::oneDay()];
+        }
     
-    // Set up array with n in 1..θ_s−1 for f_τ(d1Mod-n) (NDEMD eq. 1.7)
-    const SimTime fProdEnd = mosqRestDuration * 2;
-    for( SimTime n = mosqRestDuration+SimTime::oneDay(); n <= fProdEnd; n += SimTime::oneDay() ){
-        SimTime tn = mod_nn(d1Mod-n, N_v_length);
-        ftauArray[n] = ftauArray[n-SimTime::oneDay()] * P_A[tn];
-    }
-    ftauArray[fProdEnd] += P_df[mod_nn(d1Mod-fProdEnd, N_v_length)];
+        // Set up array with n in 1..θ_s−1 for f_τ(d1Mod-n) (NDEMD eq. 1.7)
+        const SimTime fProdEnd = mosqRestDuration * 2;
+        for( SimTime n = mosqRestDuration+SimTime::oneDay(); n <= fProdEnd; n += SimTime::oneDay() ){
+            SimTime tn = mod_nn(d1Mod-n, N_v_length);
+            ftauArray[n] = ftauArray[n-SimTime::oneDay()] * P_A[tn];
+        }
+        ftauArray[fProdEnd] += P_df[mod_nn(d1Mod-fProdEnd, N_v_length)];
 
-    for( SimTime n = fProdEnd+SimTime::oneDay(); n < EIPDuration; n += SimTime::oneDay() ){
-        SimTime tn = mod_nn(d1Mod-n, N_v_length);
-        ftauArray[n] =
-            P_df[tn] * ftauArray[n - mosqRestDuration]
-            + P_A[tn] * ftauArray[n-SimTime::oneDay()];
+        for( SimTime n = fProdEnd+SimTime::oneDay(); n < EIPDuration; n += SimTime::oneDay() ){
+            SimTime tn = mod_nn(d1Mod-n, N_v_length);
+            ftauArray[n] =
+                P_df[tn] * ftauArray[n - mosqRestDuration]
+                + P_A[tn] * ftauArray[n-SimTime::oneDay()];
+        }
+    }
+    fCacheValid = inputsConst;
+    if( tsP_A == P_A[t0] && tsP_df == P_df[t0] ){
+        fInputRun = std::min( fInputRun + SimTime::oneDay(), N_v_length );
+    }else{
+        fInputRun = SimTime::oneDay();
     }
+    //END cache calculation: fArray, ftauArray
     
-    for( SimTime d = SimTime::oneDay(); d < N_v_length; d += SimTime::oneDay() ){
-        SimTime t = mod_nn(d1Mod - d, N_v_length);
-        double sum = N_v[t];
-        for( size_t i = 0; i < Genotypes::N(); ++i ) sum -= O_v.at(t,i);
-        uninfected_v[d] = sum;
+    // Rows of P_dif, O_v and S_v hold all genotypes of one day; below,
+    // genotype is the inner loop index so that these loops vectorise.
+    // Operations are in the same order as when looping over days per
+    // genotype, so results are unchanged.
+    const double P_A0 = P_A[t0], P_dftau = P_df[ttau];
+    
+    // Num infected seeking mosquitoes is the new ones (those who were
+    // uninfected tau days ago, started a feeding cycle then, survived and
+    // got infected) + those who didn't find a host yesterday + those who
+    // found a host tau days ago and survived a feeding cycle.
+    {
+        const double uninfTau = uninfected_v[ttau];
+        const double *P_difTau = &P_dif.at(ttau,0);
+        const double *O_v0 = &O_v.at(t0,0), *O_vTau = &O_v.at(ttau,0);
+        double *O_v1 = &O_v.at(t1,0);
+        for( size_t genotype = 0; genotype < nGenotypes; ++genotype ){
+            O_v1[genotype] = P_difTau[genotype] * uninfTau
+                        + P_A0  * O_v0[genotype]
+                        + P_dftau * O_vTau[genotype];
+        }
     }
-    //END cache calculation: fArray, ftauArray, uninfected_v
     
-    double total_S_v = 0.0;
-    for( size_t genotype = 0; genotype < Genotypes::N(); ++genotype ){
-        // Num infected seeking mosquitoes is the new ones (those who were
-        // uninfected tau days ago, started a feeding cycle then, survived and
-        // got infected) + those who didn't find a host yesterday + those who
-        // found a host tau days ago and survived a feeding cycle.
-        O_v.at(t1,genotype) = P_dif.at(ttau,genotype) * uninfected_v[mosqRestDuration]
-                    + P_A[t0]  * O_v.at(t0,genotype)
-                    + P_df[ttau] * O_v.at(ttau,genotype);
-        
-        //BEGIN S_v
-        double sum = 0.0;
-        const SimTime ts = d1Mod - EIPDuration;
-        for( SimTime l = SimTime::oneDay(); l < mosqRestDuration; l += SimTime::oneDay() ){
-            const SimTime tsl = mod_nn(ts - l, N_v_length); // index d1Mod - theta_s - l
-            sum += P_dif.at(tsl,genotype) * P_df[ttau] * (uninfected_v[EIPDuration+l]) *
-                    ftauArray[EIPDuration+l-mosqRestDuration];
+    //BEGIN S_v
+    const SimTime ts = d1Mod - EIPDuration;
+    sumS_v.assign( nGenotypes, 0.0 );
+    for( SimTime l = SimTime::oneDay(); l < mosqRestDuration; l += SimTime::oneDay() ){
+        const SimTime tsl = mod_nn(ts - l, N_v_length); // index d1Mod - theta_s - l
+        const double uninf = uninfected_v[tsl];
+        const double ftau = ftauArray[EIPDuration+l-mosqRestDuration];
+        const double *P_difL = &P_dif.at(tsl,0);
+        for( size_t genotype = 0; genotype < nGenotypes; ++genotype ){
+            sumS_v[genotype] += P_difL[genotype] * P_dftau * uninf * ftau;
         }
-        
+    }
+    
+    {
         const SimTime tsm = mod_nn(ts, N_v_length);       // index d1Mod - theta_s
-        S_v.at(t1,genotype) = P_dif.at(tsm,genotype) *
-                fArray[EIPDuration-mosqRestDuration] * (uninfected_v[EIPDuration])
-            + sum
-            + P_A[t0]*S_v.at(t0,genotype)
-            + P_df[ttau]*S_v.at(ttau,genotype);
-
-
+        const double uninfS = uninfected_v[tsm];
+        const double fS = fArray[EIPDuration-mosqRestDuration];
+        const double *P_difS = &P_dif.at(tsm,0);
+        const double *S_v0 = &S_v.at(t0,0), *S_vTau = &S_v.at(ttau,0);
+        double *S_v1 = &S_v.at(t1,0);
+        for( size_t genotype = 0; genotype < nGenotypes; ++genotype ){
+            S_v1[genotype] = P_difS[genotype] * fS * uninfS
+                + sumS_v[genotype]
+                + P_A0*S_v0[genotype]
+                + P_dftau*S_vTau[genotype];
+        }
+    }
+    
+    double total_S_v = 0.0;
+    for( size_t genotype = 0; genotype < nGenotypes; ++genotype ){
         if( isDynamic ){
             // We cut-off transmission when no more than X mosquitos are infected to
             // allow true elimination in simulations. Unfortunately, it may cause problems with
@@ -257,6 +315,10 @@ void MosqTransmission::update( SimTime d0, double tsP_A, double tsP_df,
                 + P_A[t0]  * N_v[t0]
                 + nOvipositing;
     
+    double uninf = N_v[t1];
+    for( size_t i = 0; i < nGenotypes; ++i ) uninf -= O_v.at(t1,i);
+    uninfected_v[t1] = uninf;
+    
     timeStep_N_v0 += newAdults;
     
 //     if( printDebug ){
@@ -273,10 +335,25 @@ void MosqTransmission::update( SimTime d0, double tsP_A, double tsP_df,
 
 // -----  Summary and intervention functions  -----
 
+void MosqTransmission::shiftTime( SimTime offset ){
+    const SimTime n = mod_nn(offset, N_v_length);
+    P_A.rotate( n );
+    P_df.rotate( n );
+    P_dif.rotate( n );
+    P_dff.rotate( n );
+    N_v.rotate( n );
+    O_v.rotate( n );
+    S_v.rotate( n );
+    uninfected_v.rotate( n );
+    fLastDay = SimTime::never();        // fArray cache: days have changed
+    emergence->shiftTime( offset );
+}
+
 void MosqTransmission::uninfectVectors() {
     O_v.set_all( 0.0 );
     S_v.set_all( 0.0 );
     P_dif.set_all( 0.0 );
+    updateUninfected();
 }
 
 double sum1( const vecDay<double>& arr, SimTime end, SimTime N_v_length ){
@@ -28,6 +28,7 @@
 #include <limits>
 
 class MosqLifeCycleSuite;
+class VectorWarmupSampleSuite;
 
 namespace OM {
 namespace Transmission {
@@ -63,10 +64,15 @@ public:
             P_dif(move(o.P_dif)),
             P_dff(move(o.P_dff)),
             N_v(move(o.N_v)),
+            O_v(move(o.O_v)),
             S_v(move(o.S_v)),
             fArray(move(o.fArray)),
             ftauArray(move(o.ftauArray)),
             uninfected_v(move(o.uninfected_v)),
+            sumS_v(move(o.sumS_v)),
+            fLastDay(move(o.fLastDay)),
+            fInputRun(move(o.fInputRun)),
+            fCacheValid(move(o.fCacheValid)),
             timeStep_N_v0(move(o.timeStep_N_v0))
     {}
     
@@ -81,10 +87,15 @@ public:
             P_dif = move(o.P_dif);
             P_dff = move(o.P_dff);
             N_v = move(o.N_v);
+            O_v = move(o.O_v);
             S_v = move(o.S_v);
             fArray = move(o.fArray);
             ftauArray = move(o.ftauArray);
             uninfected_v = move(o.uninfected_v);
+            sumS_v = move(o.sumS_v);
+            fLastDay = move(o.fLastDay);
+            fInputRun = move(o.fInputRun);
+            fCacheValid = move(o.fCacheValid);
             timeStep_N_v0 = move(o.timeStep_N_v0);
     }
     
@@ -120,10 +131,19 @@ public:
      * @param EIR_factor see parameter partialEIR
      */
     void update( SimTime d0, double tsP_A, double tsP_df,
-                   const vector<double> tsP_dif, double tsP_dff,
+                   const vector<double>& tsP_dif, double tsP_dff,
                    bool isDynamic,
                    vector<double>& partialEIR, double EIR_factor );
     
+    /** Re-index the state, which was computed up to offset after the
+     * current time (a whole number of years), for the simulation to continue
+     * from the current time (see Simulator::fitTransmissionOnSample).
+     * 
+     * Per-day arrays are ring buffers indexed by day modulo their length;
+     * each is rotated so that the entry for day d moves to that of
+     * d - offset. */
+    void shiftTime( SimTime offset );
+    
     ///@brief Interventions and reporting
     //@{
     void uninfectVectors();
@@ -183,6 +203,14 @@ public:
         ftauArray & stream;
         uninfected_v & stream;
         timeStep_N_v0 & stream;
+        // uninfected_v is kept in the stream only for its length; the values
+        // are recalculated, since older checkpoints hold a per-lag scratch
+        // array in place of the ring indexed like N_v.
+        updateUninfected();
+        // The cache state is not checkpointed; the next update recounts
+        // fInputRun from P_A and P_df and recalculates fArray, ftauArray.
+        fLastDay = SimTime::never();
+        fCacheValid = false;
     }
     
     /** @brief Emergence model
@@ -191,6 +219,9 @@ public:
     unique_ptr<EmergenceModel> emergence;
     
 private:
+    /// Recalculate all of uninfected_v from N_v and O_v
+    void updateUninfected();
+    
     // -----  parameters (constant after initialisation)  -----
     
     /** @brief Duration parameters for mosquito/parasite life-cycle
@@ -275,28 +306,46 @@ private:
     ///@brief Working memory
     /** Used for calculations within advancePeriod. Only saved for optimisation.
      *
-     * Used to calculate recursive functions f and f_τ in NDEMD eq 1.6, 1.7.
-     * Values are recalculated each step; only fArray[0] and
-     * ftauArray[0..mosqRestDuration] are stored across steps for optimisation
-     * (reallocating each time they are needed would be slow).
+     * fArray and ftauArray are used to calculate recursive functions f and
+     * f_τ in NDEMD eq 1.6, 1.7. Values are recalculated each day unless P_A
+     * and P_df are unchanged over the days used (see fInputRun); fArray[0]
+     * and ftauArray[0..mosqRestDuration] are constant.
      * 
-     * uninfected_v[0] is not used.
+     * uninfected_v is N_v - sum of O_v over genotypes, with the same index
+     * (mod N_v_length) as those. It is set along with N_v each day, and must
+     * be recalculated (updateUninfected) whenever N_v or O_v are changed
+     * otherwise, including on reading a checkpoint.
      *
      * Length (fArray): EIPDuration - mosqRestDuration + 1 (θ_s - τ + 1)
      * Length (ftauArray): EIPDuration (θ_s)
      * Length (uninfected_v): N_v_length
-     *
-     * Don't need to be checkpointed, but some values need to be initialised. */
+     * Length (sumS_v): number of genotypes; not checkpointed */
     //@{
     vecDay<double> fArray;
     vecDay<double> ftauArray;
     vecDay<double> uninfected_v;
+    vector<double> sumS_v;
+    //@}
+    
+    /** State of the fArray / ftauArray cache.
+     * 
+     * fLastDay is d0 of the last update. fInputRun is the number of days up
+     * to that of the last update's P_A and P_df values over which these were
+     * constant. fCacheValid is true when fArray and ftauArray were last
+     * calculated from constant P_A and P_df.
+     * 
+     * Not checkpointed: the cache is invalidated on checkpointing. */
+    //@{
+    SimTime fLastDay;
+    SimTime fInputRun;
+    bool fCacheValid;
     //@}
     
     /** Variables tracking data to be reported. */
     double timeStep_N_v0;
     
     friend class ::MosqLifeCycleSuite;
+    friend class ::VectorWarmupSampleSuite;
 };
 
 }
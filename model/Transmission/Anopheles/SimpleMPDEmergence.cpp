@@ -106,6 +106,7 @@ bool SimpleMPDEmergence::initIterate (MosqTransmission& transmission) {
     // EIR comes directly from S_v, so should fit after we're done.
 
     double factor = vectors::sum (forcedS_v)*5 / vectors::sum(quinquennialS_v);
+    lastFitFactor = factor;
     //cout << "Pre-calced Sv, dynamic Sv:\t"<<sumAnnualForcedS_v<<'\t'<<vectors::sum(annualS_v)<<endl;
     if (!(factor > 1e-6 && factor < 1e6)) {
         if ( vectors::sum(forcedS_v) == 0.0 ) {
@@ -191,6 +192,14 @@ double SimpleMPDEmergence::update( SimTime d0, double nOvipositing, double S_v )
     return emergence;
 }
 
+void SimpleMPDEmergence::shiftTime( SimTime offset ){
+    // mosqEmergeRate, invLarvalResources are per day of the year, which
+    // offset does not change
+    quinquennialS_v.rotate( mod_nn(offset, quinquennialS_v.size()) );
+    quinquennialOvipositing.rotate( mod_nn(offset, quinquennialOvipositing.size()) );
+    nOvipositingDelayed.rotate( mod_nn(offset, developmentDuration) );
+}
+
 double SimpleMPDEmergence::getResAvailability() const {
     //TODO: why offset by one time step? This is effectively getting the resources available on the last time step
     //TODO: only have to add one year because of offset
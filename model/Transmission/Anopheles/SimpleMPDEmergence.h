@@ -75,6 +75,11 @@ public:
     //@}
     
     virtual double update( SimTime d0, double nOvipositing, double S_v );
+    virtual void shiftTime( SimTime offset );
+    
+    virtual const vecDay<double>& getEmergenceRate() const{
+        return mosqEmergeRate;
+    }
     
     ///@brief Interventions and reporting
     //@{
@@ -38,11 +38,21 @@ void PerHost::init ( const scnXml::AgeGroupValues& availabilityToMosquitoes ) {
     relAvailAge.set( availabilityToMosquitoes, "availabilityToMosquitoes" );
 }
 
+void PerHostInterventionData::multiplyFactors( vector<SpeciesFactors>& factors ) const{
+    for( size_t s = 0; s < factors.size(); ++s ){
+        factors[s].availability *= relativeAttractiveness( s );
+        factors[s].probBiting *= preprandialSurvivalFactor( s );
+        factors[s].probResting *= postprandialSurvivalFactor( s );
+        factors[s].fecundity *= relFecundity( s );
+    }
+}
+
 // -----  PerHost non-static -----
 
 PerHost::PerHost () :
         outsideTransmission(false),
-        _relativeAvailabilityHet(numeric_limits<double>::signaling_NaN())
+        _relativeAvailabilityHet(numeric_limits<double>::signaling_NaN()),
+        factorTime(SimTime::never())
 {
 }
 void PerHost::initialise (LocalRng& rng, double availabilityFactor) {
@@ -57,9 +67,11 @@ void PerHost::update(Host::Human& human){
     for( auto iter = activeComponents.begin(); iter != activeComponents.end(); ++iter ){
         (*iter)->update(human);
     }
+    invalidateFactors();
 }
 
 void PerHost::deployComponent( LocalRng& rng, const HumanVectorInterventionComponent& params ){
+    invalidateFactors();
     // This adds per-host per-intervention details to the host's data set.
     // This data is never removed since it can contain per-host heterogeneity samples.
     for( auto iter = activeComponents.begin(); iter != activeComponents.end(); ++iter ){
@@ -79,34 +91,18 @@ void PerHost::deployComponent( LocalRng& rng, const HumanVectorInterventionCompo
 // (easily large enough for conceivable Weibull params that the value is 0.0 when
 // rounded to a double. Performance-wise it's perhaps slightly slower than using
 // an if() when interventions aren't present.
-double PerHost::entoAvailabilityHetVecItv (size_t species) const {
-    double alpha_i = speciesData[species].getEntoAvailability();
-    for( auto iter = activeComponents.begin(); iter != activeComponents.end(); ++iter ){
-        alpha_i *= (*iter)->relativeAttractiveness( species );
-    }
-    return alpha_i;
-}
-double PerHost::probMosqBiting (size_t species) const {
-    double P_B_i = speciesData[species].getProbMosqBiting();
-    for( auto iter = activeComponents.begin(); iter != activeComponents.end(); ++iter ){
-        P_B_i *= (*iter)->preprandialSurvivalFactor( species );
-    }
-    return P_B_i;
-}
-double PerHost::probMosqResting (size_t species) const {
-    double pRest = speciesData[species].getProbMosqRest();
-    for( auto iter = activeComponents.begin(); iter != activeComponents.end(); ++iter ){
-        pRest *= (*iter)->postprandialSurvivalFactor( species );
+void PerHost::updateFactors() const{
+    factorCache.resize( speciesData.size() );
+    for( size_t s = 0; s < speciesData.size(); ++s ){
+        factorCache[s].availability = speciesData[s].getEntoAvailability();
+        factorCache[s].probBiting = speciesData[s].getProbMosqBiting();
+        factorCache[s].probResting = speciesData[s].getProbMosqRest();
+        factorCache[s].fecundity = 1.0;
     }
-    return pRest;
-}
-
-double PerHost::relMosqFecundity (size_t species) const {
-    double relFecundity = 1.0;
     for( auto iter = activeComponents.begin(); iter != activeComponents.end(); ++iter ){
-        relFecundity *= (*iter)->relFecundity( species );
+        (*iter)->multiplyFactors( factorCache );
     }
-    return relFecundity;
+    factorTime = sim::nowOrTs1();
 }
 
 bool PerHost::hasActiveInterv(interventions::Component::Type type) const{
@@ -129,6 +125,7 @@ void PerHost::checkpointIntervs( istream& stream ){
     size_t l;
     l & stream;
     validateListSize(l);
+    invalidateFactors();
     activeComponents.clear();
     for( size_t i = 0; i < l; ++i ){
         interventions::ComponentId id( stream );
@@ -40,6 +40,13 @@ using util::LocalRng;
 
 class HumanVectorInterventionComponent;
 
+/** Combined effects of host and vector interventions on one mosquito
+ * species: the values of PerHost::entoAvailabilityHetVecItv(),
+ * probMosqBiting(), probMosqResting() and relMosqFecundity(). */
+struct SpeciesFactors {
+    double availability, probBiting, probResting, fecundity;
+};
+
 /**
  * A base class for interventions affecting human-vector interaction.
  * 
@@ -76,6 +83,14 @@ public:
     /// Get the mosquito fecundity multiplier (1 for no effect).
     virtual double relFecundity(size_t species) const =0;
     
+    /** Multiply the effects of this intervention into factors (one element
+     * per species): relativeAttractiveness() into availability,
+     * preprandialSurvivalFactor() into probBiting, etc.
+     * 
+     * The default implementation calls the functions above. Implementations
+     * should override it to evaluate decay only once for all species. */
+    virtual void multiplyFactors( vector<SpeciesFactors>& factors ) const;
+    
     /// Index of effect describing the intervention
     inline interventions::ComponentId id() const { return m_id; }
     
@@ -202,7 +217,9 @@ public:
      * rate factors.)
      * 
      * Assume mean is human-to-vector availability rate factor. */
-    double entoAvailabilityHetVecItv (size_t species) const;
+    inline double entoAvailabilityHetVecItv (size_t species) const{
+        return factors(species).availability;
+    }
     
     /** Availability rate of human to mosquitoes (α_i). Equals 
      * entoAvailabilityHetVecItv()*getRelativeAvailability().
@@ -220,21 +237,28 @@ public:
     ///@brief Get effects of interventions pre/post biting
     //@{
     /** Probability of a mosquito succesfully biting a host (P_B_i). */
-    double probMosqBiting (size_t species) const;
+    inline double probMosqBiting (size_t species) const{
+        return factors(species).probBiting;
+    }
     /** Probability of a mosquito succesfully finding a resting
      * place after biting and then resting (P_C_i * P_D_i). */
-    double probMosqResting (size_t species) const;
+    inline double probMosqResting (size_t species) const{
+        return factors(species).probResting;
+    }
     /** Multiplicative factor for the number of fertile eggs laid by mosquitoes
      * after feeding on this host. Should be 1 normally, less than 1 to reduce
      * fertility, greater than 1 to increase. */
-    double relMosqFecundity (size_t species) const;
+    inline double relMosqFecundity (size_t species) const{
+        return factors(species).fecundity;
+    }
     //@}
     
     ///@brief Convenience wrappers around several functions
     //@{
     /// entoAvailabilityHetVecItv * probMosqBiting
     inline double availBite (size_t species) const{
-        return entoAvailabilityHetVecItv(species) * probMosqBiting(species);
+        const SpeciesFactors& f = factors(species);
+        return f.availability * f.probBiting;
     }
     //@}
     
@@ -266,6 +290,23 @@ private:
     void checkpointIntervs( ostream& stream );
     void checkpointIntervs( istream& stream );
     
+    /** Get intervention factors for a species.
+     * 
+     * Interventions decay with time (sim::nowOrTs1()), and change on
+     * update() and deployment. Factors for all species are calculated
+     * together on first use after any of these, then cached; thus the
+     * several uses per step (vector model update, EIR calculation) are
+     * mostly lookups. */
+    inline const SpeciesFactors& factors( size_t species ) const{
+        if( factorTime != sim::nowOrTs1() ) updateFactors();
+        return factorCache[species];
+    }
+    void updateFactors() const;
+    /// Mark factorCache as out of date
+    inline void invalidateFactors(){
+        factorTime = SimTime::never();
+    }
+    
     vector<PerHostAnoph> speciesData;
     
     // Determines whether human is outside transmission
@@ -277,6 +318,11 @@ private:
 
     vector<unique_ptr<PerHostInterventionData>> activeComponents;
     
+    // Cache for factors(), per species; valid if factorTime is
+    // sim::nowOrTs1(). Not checkpointed.
+    mutable vector<SpeciesFactors> factorCache;
+    mutable SimTime factorTime;
+    
     static AgeGroupInterpolator relAvailAge;
 };
 
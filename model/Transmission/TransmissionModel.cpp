@@ -24,6 +24,7 @@
 #include "Transmission/PerHost.h"
 
 #include "Population.h"
+#include "SimContext.h"
 #include "WithinHost/WHInterface.h"
 #include "WithinHost/Genotypes.h"
 #include "mon/Continuous.h"
@@ -31,6 +32,7 @@
 #include "util/StreamValidator.h"
 #include "util/CommandLine.h"
 #include "util/vectors.h"
+#include "util/parallel.h"
 #include "util/ModelOptions.h"
 
 #include <cmath>
@@ -40,9 +42,15 @@
 namespace OM { namespace Transmission {
 namespace vectors = util::vectors;
 
-// Reporting data. Doesn't need checkpointing due to reset every time-step.
-static double tsAdultEntoInocs = 0.0;  // accumulator for time step EIR of adults
-static int tsNumAdults = 0; // accumulator for time step adults requesting EIR
+// Reporting data (SimContext::tsAdultEntoInocs and tsNumAdults) doesn't need
+// checkpointing due to reset every time-step.
+
+// Add the EIR of one adult to the above (via util::parallel::accumulate)
+static void accumulateAdultEIR( size_t, double allEIR ){
+    SimContext& ctx = SimContext::current();
+    ctx.tsAdultEntoInocs += allEIR;
+    ctx.tsNumAdults += 1;
+}
 
 
 TransmissionModel* TransmissionModel::createTransmissionModel (
@@ -136,24 +144,67 @@ TransmissionModel::~TransmissionModel () {
 }
 
 
+void TransmissionModel::HostSnapshot::resize( size_t n, size_t nSpecies, size_t nGenotypes ){
+    nHumans = n;
+    avail.resize( n * nSpecies );
+    df.resize( n * nSpecies );
+    fecundity.resize( n * nSpecies );
+    pTransmit.resize( n * nGenotypes );
+}
+
+void TransmissionModel::HostSnapshot::sumSpecies( size_t s, double weight,
+        double& sumAvail, double& sumDf, double& sumDff,
+        vector<double>& sumDif ) const
+{
+    const double *pAvail = &avail[s * nHumans];
+    const double *pDf = &df[s * nHumans];
+    const double *pFecundity = &fecundity[s * nHumans];
+    // locals: the outputs may alias the arrays
+    double sA = 0.0, sDf = 0.0, sDff = 0.0;
+    for( size_t i = 0; i < nHumans; ++i ){
+        sA += pAvail[i];
+        sDf += pDf[i];
+        sDff += pDf[i] * pFecundity[i];
+    }
+    sumAvail = sA * weight;
+    sumDf = sDf * weight;
+    sumDff = sDff * weight;
+    for( size_t g = 0; g < sumDif.size(); ++g ){
+        const double *pTrans = &pTransmit[g * nHumans];
+        double sum = 0.0;
+        for( size_t i = 0; i < nHumans; ++i ){
+            sum += pDf[i] * pTrans[i];
+        }
+        sumDif[g] = sum * weight;
+    }
+}
+
 double TransmissionModel::updateKappa (const Population& population) {
     // We calculate kappa for output and the non-vector model.
+    const size_t nHumans = population.size();
+    snapshot.resize( nHumans, 1, 1 );
+    Population::ConstIter humans = population.crange().first;
+    util::parallel::forChunks( nHumans, [&]( size_t begin, size_t end ){
+        for( size_t i = begin; i < end; ++i ){
+            const Host::Human& human = humans[i];
+            //NOTE: calculate availability relative to age at end of time step;
+            // not my preference but consistent with TransmissionModel::getEIR().
+            snapshot.avail[i] = human.perHostTransmission.relativeAvailabilityHetAge(
+                human.age(sim::ts1()).inYears());
+            const double tbvFactor = human.getVaccine().getFactor( interventions::Vaccine::TBV );
+            snapshot.pTransmit[i] = human.withinHostModel->probTransmissionToMosquito( tbvFactor, 0 );
+        }
+    } );
+    
     double sumWt_kappa= 0.0;
     double sumWeight  = 0.0;
     numTransmittingHumans = 0;
-
-    foreach(const Host::Human& human, population.crange()) {
-        //NOTE: calculate availability relative to age at end of time step;
-        // not my preference but consistent with TransmissionModel::getEIR().
-        const double avail = human.perHostTransmission.relativeAvailabilityHetAge(
-            human.age(sim::ts1()).inYears());
-        sumWeight += avail;
-        const double tbvFactor = human.getVaccine().getFactor( interventions::Vaccine::TBV );
-        const double pTransmit = human.withinHostModel->probTransmissionToMosquito( tbvFactor, 0 );
-        const double riskTrans = avail * pTransmit;
+    const double *avail = snapshot.avail.data(), *pTransmit = snapshot.pTransmit.data();
+    for( size_t i = 0; i < nHumans; ++i ){
+        sumWeight += avail[i];
+        const double riskTrans = avail[i] * pTransmit[i];
         sumWt_kappa += riskTrans;
-        if( riskTrans > 0.0 )
-            ++numTransmittingHumans;
+        numTransmittingHumans += riskTrans > 0.0 ? 1 : 0;
     }
 
 
@@ -179,9 +230,10 @@ double TransmissionModel::updateKappa (const Population& population) {
         _sumAnnualKappa = 0.0;
     }
     
-    tsAdultEIR = tsAdultEntoInocs / tsNumAdults;
-    tsAdultEntoInocs = 0.0;
-    tsNumAdults = 0;
+    SimContext& ctx = SimContext::current();
+    tsAdultEIR = ctx.tsAdultEntoInocs / ctx.tsNumAdults;
+    ctx.tsAdultEntoInocs = 0.0;
+    ctx.tsNumAdults = 0;
     
     surveyInputEIR += initialisationEIR[tmod];
     surveySimulatedEIR += tsAdultEIR;
@@ -201,8 +253,7 @@ double TransmissionModel::getEIR( Host::Human& human, SimTime age,
     
     double allEIR = vectors::sum( EIR );
     if( age >= adultAge ){
-        tsAdultEntoInocs += allEIR;
-        tsNumAdults += 1;
+        util::parallel::accumulate( &accumulateAdultEIR, 0, allEIR );
     }
     return allEIR;
 }
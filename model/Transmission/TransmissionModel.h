@@ -28,6 +28,7 @@
 #include <fstream>
 #include <string.h>
 
+class VectorWarmupSampleSuite;
 namespace OM {
 class Summary;
 class Population;
@@ -145,6 +146,9 @@ public:
    * and return the length of sim-time before this should be called again.
    */
   virtual SimTime initIterate ()=0;
+  /** True when the time requested by the last call to initIterate() is for
+   * collecting data to fit to (rather than final stabilisation). */
+  virtual bool inFittingRound () const { return false; }
   
   /** Needs to be called each step of the simulation before Human::update().
    *
@@ -204,6 +208,17 @@ public:
    * infection, humans will then be exposed to zero EIR. */
   virtual void uninfectVectors() =0;
   
+  /** The model was stepped to offset (a whole number of years) after the
+   * current time, with the clock of another SimContext (see
+   * Simulator::fitTransmissionOnSample). Re-index time-indexed state so
+   * that the simulation can continue from the current time. */
+  virtual void shiftTime( SimTime offset ) {}
+  
+  /** Re-seed any random number generator owned by the model, as if it had
+   * been constructed with these seeds. Only valid before the simulation
+   * starts. */
+  virtual void reseed( uint64_t seed1, uint64_t seed2 ) {}
+  
 protected:
   /** Calculates the EIR individuals are exposed to.
    * 
@@ -222,6 +237,40 @@ protected:
    * human infectiousness weighted by availability to mosquitoes). */
   double updateKappa (const Population& population);
   
+  /** Per-human quantities used by population-wide sums, stored as
+   * structure-of-arrays.
+   * 
+   * These are copied from the humans in one pass (which may be split over
+   * threads, see util::parallel), after which the sums are plain loops over
+   * contiguous arrays. Summation order is by human, as before, so results
+   * are unchanged. Per-species and per-genotype values for human i are at
+   * index [s * nHumans + i] and [g * nHumans + i].
+   * 
+   * Contents are only valid within the function filling them, and are not
+   * checkpointed. The arrays are kept to avoid reallocation each step. */
+  struct HostSnapshot {
+      void resize( size_t nHumans, size_t nSpecies, size_t nGenotypes );
+      
+      /** Sums over humans for species s, each human standing for weight
+       * humans (see Population::getSampleWeight): of avail, of df, of
+       * df * fecundity and, for each genotype g < sumDif.size(), of
+       * df * pTransmit (into sumDif[g]). */
+      void sumSpecies( size_t s, double weight, double& sumAvail,
+              double& sumDf, double& sumDff, vector<double>& sumDif ) const;
+      
+      size_t nHumans;
+      /// Availability to mosquitoes: relative (updateKappa) or per species
+      vector<double> avail;
+      /// avail * P_B * P_C * P_D, per species
+      vector<double> df;
+      /// Relative mosquito fecundity after feeding, per species
+      vector<double> fecundity;
+      /// Probability of transmission to mosquito (including TBV effect);
+      /// per genotype in vectorUpdate
+      vector<double> pTransmit;
+  };
+  HostSnapshot snapshot;
+  
   virtual void checkpoint (istream& stream);
   virtual void checkpoint (ostream& stream);
   
@@ -300,6 +349,8 @@ private:
 
   /// For "num transmitting humans" cts output.
   int numTransmittingHumans;
+  
+  friend class ::VectorWarmupSampleSuite;
 };
 
 } }
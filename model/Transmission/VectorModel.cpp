@@ -20,18 +20,22 @@
 
 #include "Transmission/VectorModel.h"
 #include "Population.h"
+#include "SimContext.h"
 #include "Host/Human.h"
 #include "WithinHost/WHInterface.h"
 #include "WithinHost/Genotypes.h"
 #include "mon/Continuous.h"
 #include "util/vectors.h"
 #include "util/ModelOptions.h"
+#include "util/CommandLine.h"
+#include "util/parallel.h"
 #include "util/SpeciesIndexChecker.h"
 
 #include <fstream>
 #include <map>
 #include <cmath>
 #include <set>
+#include <sstream>
 
 namespace OM {
 namespace Transmission {
@@ -260,11 +264,14 @@ VectorModel::~VectorModel () {
 }
 
 void VectorModel::init2 (const Population& population) {
-    SimTime data_save_len = SimTime::oneDay();  // we don't need to save anything at first
+    // We don't need to save anything at first, except for fitEquilibrium():
+    SimTime data_save_len = CommandLine::option( CommandLine::FAST_VECTOR_WARMUP ) ||
+            CommandLine::getVectorWarmupSample() > 0 ?
+            SimTime::oneYear() : SimTime::oneDay();
     saved_sum_avail.assign( data_save_len, speciesIndex.size(), 0.0 );
     saved_sigma_df.assign( data_save_len, speciesIndex.size(), 0.0 );
     saved_sigma_dif.assign( data_save_len, speciesIndex.size(), WithinHost::Genotypes::N(), 0.0 );
-    saved_sigma_dff.assign( speciesIndex.size(), 0.0 );
+    saved_sigma_dff.assign( data_save_len, speciesIndex.size(), 0.0 );
     
     double sumRelativeAvailability = 0.0;
     foreach(const Host::Human& human, population.crange()) {
@@ -364,6 +371,10 @@ SimTime VectorModel::minPreinitDuration () {
     return SimTime::fromYearsI( 55 );
 }
 SimTime VectorModel::expectedInitDuration (){
+    if( CommandLine::option( CommandLine::FAST_VECTOR_WARMUP ) &&
+            !CommandLine::option( CommandLine::DEBUG_VECTOR_FITTING ) ){
+        return SimTime::zero();
+    }
     return SimTime::oneYear();
 }
 
@@ -373,6 +384,37 @@ SimTime VectorModel::initIterate () {
         return SimTime::zero(); // no initialization to do
     }
     
+    if( initIterations == 0 && CommandLine::option( CommandLine::FAST_VECTOR_WARMUP ) ){
+        fitEquilibrium( true );
+        if( CommandLine::option( CommandLine::DEBUG_VECTOR_FITTING ) ){
+            // Check the fast fit: classic fitting rounds follow, the first
+            // starting from the fast fit, and we report how they change it.
+            refEmergence.resize( speciesIndex.size() );
+            for(size_t i = 0; i < speciesIndex.size(); ++i) {
+                refEmergence[i] = species[i].getEmergenceRate().internal();
+            }
+            initIterations = 1;
+            return SimTime::oneYear() + SimTime::fromYearsI(5);
+        }
+        initIterations = -1;    // done: no stabilisation year needed
+    }
+    if( initIterations == 0 && CommandLine::getVectorWarmupSample() > 0 ){
+        // Fitting rounds will use a sample of humans (see
+        // Simulator::fitTransmissionOnSample). As a reference, fit on the
+        // full population with the fast method (replaying its last year, as
+        // --fast-vector-warmup) and undo that fit. A classic round on the
+        // full population would cost what the sample saves.
+        ostringstream initial;
+        species & initial;
+        fitEquilibrium( false );
+        refEmergence.resize( speciesIndex.size() );
+        for(size_t i = 0; i < speciesIndex.size(); ++i) {
+            refEmergence[i] = species[i].getEmergenceRate().internal();
+        }
+        istringstream restore( initial.str() );
+        species & restore;
+    }
+    
     // This function is called repeatedly until vector initialisation is
     // complete (signalled by returning 0).
     int initState = 0;
@@ -394,6 +436,7 @@ SimTime VectorModel::initIterate () {
         saved_sum_avail.assign( data_save_len, speciesIndex.size(), 0.0 );
         saved_sigma_df.assign( data_save_len, speciesIndex.size(), 0.0 );
         saved_sigma_dif.assign( data_save_len, speciesIndex.size(), WithinHost::Genotypes::N(), 0.0 );
+        saved_sigma_dff.assign( data_save_len, speciesIndex.size(), 0.0 );
         
 //         if( initState == 1 ){
 //             return SimTime::fromYearsI(5);
@@ -420,12 +463,139 @@ SimTime VectorModel::initIterate () {
         // stabilization + 5 years data-collection time:
         return SimTime::oneYear() + SimTime::fromYearsI(5);
     } else {
+        if( !refEmergence.empty() && CommandLine::option( CommandLine::FAST_VECTOR_WARMUP ) ){
+            // the first round was the fast fit
+            cout << "Fast vector warm-up checked by " << initIterations - 1
+                << " classic fitting round(s)" << endl;
+            reportEmergenceChange( "the fast fit" );
+        }else if( !refEmergence.empty() ){
+            cout << "Vector warm-up on a sample of " << CommandLine::getVectorWarmupSample()
+                << " humans: " << initIterations << " fitting round(s)" << endl;
+            reportEmergenceChange( "the fast fit on the full population" );
+        }
         // One year stabilisation, then we're finished:
         initIterations = -1;
         return SimTime::oneYear();
     }
 }
 
+bool VectorModel::inFittingRound () const{
+    return interventionMode == dynamicEIR && initIterations > 0;
+}
+
+void VectorModel::fitEquilibrium (bool report){
+    const size_t nSpecies = speciesIndex.size();
+    // The state is taken to be periodic when annual S_v changes by no more
+    // than this (relatively) between the last two years replayed:
+    const double TOLERANCE = 1e-6;
+    const int MAX_YEARS = 64;
+    
+    vector<vector<double>> annualS_v;
+    vector<double> residual( nSpecies, 0.0 );
+    int rounds = 0, yearsReplayed = 0;
+    auto solvePeriodic = [&]( int nYears ){
+        for(;;){
+            // Restarting at an earlier time perturbs the state; this washes out
+            replayYears( nYears, annualS_v );
+            yearsReplayed += nYears;
+            bool periodic = true;
+            for( size_t s = 0; s < nSpecies; ++s ){
+                const double last = annualS_v[s][nYears - 1];
+                const double prev = annualS_v[s][nYears - 2];
+                residual[s] = last == prev ? 0.0 :
+                        fabs(last - prev) / max(fabs(last), fabs(prev));
+                periodic = periodic && residual[s] <= TOLERANCE;
+            }
+            if( periodic ) return;
+            if( nYears * 2 > MAX_YEARS ){
+                throw TRACED_EXCEPTION("fast vector warm-up: mosquito population "
+                    "did not reach a periodic state", util::Error::VectorWarmup);
+            }
+            nYears *= 2;
+        }
+    };
+    
+    // Rounds as in initIterate(): stabilisation plus five years of data
+    // (quinquennialS_v) for each fit, one year after the last.
+    bool needIterate = true;
+    while( needIterate ){
+        if( rounds >= 10 ){
+            throw TRACED_EXCEPTION("Transmission warmup exceeded 10 iterations!",util::Error::VectorWarmup);
+        }
+        solvePeriodic( 6 );
+        ++rounds;
+        needIterate = false;
+        for(size_t i = 0; i < nSpecies; ++i) {
+            // short-circuits as in initIterate()
+            needIterate = needIterate || species[i].initIterate ();
+        }
+    }
+    solvePeriodic( 2 );
+    if( !report ) return;
+    
+    cout << "Fast vector warm-up: " << rounds << " fitting round(s), "
+        << yearsReplayed << " years of mosquito dynamics replayed" << endl;
+    for( auto it = speciesIndex.begin(); it != speciesIndex.end(); ++it ){
+        // The classic warm-up stops once a fit changes emergence by at most
+        // 10%; the same criterion ends the rounds above.
+        cout << "  " << it->first << ": last fit factor "
+            << species[it->second].fitFactor()
+            << " (classic warm-up accepts 0.9 to 1.1), periodic residual "
+            << residual[it->second] << endl;
+    }
+}
+
+void VectorModel::reportEmergenceChange (const char* ref){
+    for( auto it = speciesIndex.begin(); it != speciesIndex.end(); ++it ){
+        const vector<double>& fitted = species[it->second].getEmergenceRate().internal();
+        const vector<double>& refRate = refEmergence[it->second];
+        double diff = 0.0, sumFitted = 0.0, sumRef = 0.0;
+        for( size_t d = 0; d < refRate.size(); ++d ){
+            diff += fabs( fitted[d] - refRate[d] );
+            sumFitted += fitted[d];
+            sumRef += refRate[d];
+        }
+        cout << "  " << it->first << ": emergence differs from " << ref
+            << " by " << 100.0 * diff / sumRef
+            << "% (annual total: " << 100.0 * (sumFitted - sumRef) / sumRef
+            << "%)" << endl;
+    }
+    refEmergence.clear();
+}
+
+void VectorModel::replayYears (int nYears, vector<vector<double>>& annualS_v){
+    assert( saved_sum_avail.size1() == SimTime::oneYear() && nYears >= 2 );
+    const size_t nSpecies = speciesIndex.size();
+    const SimTime start = sim::now() - SimTime::fromYearsI(nYears);
+    annualS_v.assign( nSpecies, vector<double>( nYears, 0.0 ) );
+    sigma_dif_species.resize( nSpecies );
+    
+    // Species are independent given the saved sums (see vectorUpdate)
+    util::parallel::forChunks( nSpecies, [&]( size_t begin, size_t end ){
+        // Each chunk steps its own clock; the simulation's is not changed
+        SimContext replay;
+        SimContext::Bind bind( replay );
+        for( size_t s = begin; s < end; ++s ){
+            replay.clock.t0 = replay.clock.t1 = start;
+            for( int y = 0; y < nYears; ++y ){
+                for( size_t step = 0; step < sim::stepsPerYear(); ++step ){
+                    replay.clock.startStep();
+                    SimTime popDataInd = mod_nn(sim::ts0(), saved_sum_avail.size1());
+                    auto range = saved_sigma_dif.range_at12(popDataInd, s);
+                    sigma_dif_species[s].assign(range.first, range.second);
+                    species[s].advancePeriod (saved_sum_avail.at(popDataInd, s),
+                            saved_sigma_df.at(popDataInd, s),
+                            sigma_dif_species[s],
+                            saved_sigma_dff.at(popDataInd, s),
+                            false);
+                    replay.clock.endStep();
+                    annualS_v[s][y] += species[s].getLastVecStat(Anopheles::SV);
+                }
+            }
+        }
+    } );
+}
+
 void VectorModel::calculateEIR(Host::Human& human, double ageYears,
         vector<double>& EIR) const
 {
@@ -468,55 +638,72 @@ void VectorModel::calculateEIR(Host::Human& human, double ageYears,
 void VectorModel::vectorUpdate (const Population& population) {
     const size_t nGenotypes = WithinHost::Genotypes::N();
     SimTime popDataInd = mod_nn(sim::ts0(), saved_sum_avail.size1());
-    vector<double> probTransmission;
-    saved_sum_avail.assign_at1(popDataInd, 0.0);
-    saved_sigma_df.assign_at1(popDataInd, 0.0);
-    saved_sigma_dif.assign_at1(popDataInd, 0.0);
-    saved_sigma_dff.assign( saved_sigma_dff.size(), 0.0 );
+    const size_t nSpecies = speciesIndex.size();
+    const size_t nHumans = population.size();
     
-    foreach(const Host::Human& human, population.crange()) {
-        const OM::Transmission::PerHost& host = human.perHostTransmission;
-        WithinHost::WHInterface& whm = *human.withinHostModel;
-        const double tbvFac = human.getVaccine().getFactor( interventions::Vaccine::TBV );
-        
-        probTransmission.assign( nGenotypes, 0.0 );
-        double sumX = numeric_limits<double>::quiet_NaN();
-        const double pTrans = whm.probTransmissionToMosquito( tbvFac, &sumX );
-        if( nGenotypes == 1 ) probTransmission[0] = pTrans;
-        else for( size_t g = 0; g < nGenotypes; ++g ){
-            const double k = whm.probTransGenotype( pTrans, sumX, g );
-            assert( (boost::math::isfinite)(k) );
-            probTransmission[g] = k;
-        }
-        
-        for(size_t s = 0; s < speciesIndex.size(); ++s){
+    // Copy per-human data (see HostSnapshot)
+    snapshot.resize( nHumans, nSpecies, nGenotypes );
+    Population::ConstIter humans = population.crange().first;
+    util::parallel::forChunks( nHumans, [&]( size_t begin, size_t end ){
+        for( size_t i = begin; i < end; ++i ){
+            const Host::Human& human = humans[i];
+            const OM::Transmission::PerHost& host = human.perHostTransmission;
+            WithinHost::WHInterface& whm = *human.withinHostModel;
+            const double tbvFac = human.getVaccine().getFactor( interventions::Vaccine::TBV );
+            
+            double sumX = numeric_limits<double>::quiet_NaN();
+            const double pTrans = whm.probTransmissionToMosquito( tbvFac, &sumX );
+            if( nGenotypes == 1 ) snapshot.pTransmit[i] = pTrans;
+            else for( size_t g = 0; g < nGenotypes; ++g ){
+                const double k = whm.probTransGenotype( pTrans, sumX, g );
+                assert( (boost::math::isfinite)(k) );
+                snapshot.pTransmit[g * nHumans + i] = k;
+            }
+            
             //NOTE: calculate availability relative to age at end of time step;
             // not my preference but consistent with TransmissionModel::getEIR().
             //TODO: even stranger since probTransmission comes from the previous time step
-            const double avail = host.entoAvailabilityFull (s, human.age(sim::ts1()).inYears());
-            saved_sum_avail.at(popDataInd, s) += avail;
-            const double df = avail
-                    * host.probMosqBiting(s)
-                    * host.probMosqResting(s);
-            saved_sigma_df.at(popDataInd, s) += df;
-            for( size_t g = 0; g < nGenotypes; ++g ){
-                saved_sigma_dif.at(popDataInd, s, g) += df * probTransmission[g];
+            const double ageYears = human.age(sim::ts1()).inYears();
+            for( size_t s = 0; s < nSpecies; ++s ){
+                const double avail = host.entoAvailabilityFull (s, ageYears);
+                snapshot.avail[s * nHumans + i] = avail;
+                snapshot.df[s * nHumans + i] = avail
+                        * host.probMosqBiting(s)
+                        * host.probMosqResting(s);
+                snapshot.fecundity[s * nHumans + i] = host.relMosqFecundity(s);
             }
-            saved_sigma_dff[s] += df * host.relMosqFecundity(s);
         }
-    }
+    } );
     
-    for(size_t s = 0; s < speciesIndex.size(); ++s){
-        // Copy slice to new array:
-        auto range = saved_sigma_dif.range_at12(popDataInd, s);
-        sigma_dif_species.assign(range.first, range.second);
-        
-        species[s].advancePeriod (saved_sum_avail.at(popDataInd, s),
+    // Sum over humans, per species. Each human stands for weight humans
+    // when a sample of the population is simulated (see Population).
+    const double weight = population.getSampleWeight();
+    vector<double> sumDif( nGenotypes );
+    for( size_t s = 0; s < nSpecies; ++s ){
+        snapshot.sumSpecies( s, weight, saved_sum_avail.at(popDataInd, s),
                 saved_sigma_df.at(popDataInd, s),
-                sigma_dif_species,
-                saved_sigma_dff[s],
-                simulationMode == dynamicEIR);
+                saved_sigma_dff.at(popDataInd, s), sumDif );
+        for( size_t g = 0; g < nGenotypes; ++g ){
+            saved_sigma_dif.at(popDataInd, s, g) = sumDif[g];
+        }
     }
+    
+    // Species interact only through the sums above, and advancePeriod uses
+    // no random numbers, so species may be advanced in any order.
+    sigma_dif_species.resize( nSpecies );
+    util::parallel::forChunks( nSpecies, [&]( size_t begin, size_t end ){
+        for( size_t s = begin; s < end; ++s ){
+            // Copy slice to new array:
+            auto range = saved_sigma_dif.range_at12(popDataInd, s);
+            sigma_dif_species[s].assign(range.first, range.second);
+            
+            species[s].advancePeriod (saved_sum_avail.at(popDataInd, s),
+                    saved_sigma_df.at(popDataInd, s),
+                    sigma_dif_species[s],
+                    saved_sigma_dff.at(popDataInd, s),
+                    simulationMode == dynamicEIR);
+        }
+    } );
 }
 void VectorModel::update(const Population& population) {
     TransmissionModel::updateKappa(population);
@@ -549,6 +736,17 @@ void VectorModel::uninfectVectors() {
         species[i].uninfectVectors();
 }
 
+void VectorModel::shiftTime( SimTime offset ){
+    // Emergence rates and saved population sums are per day of the year
+    assert( mod_nn(offset, SimTime::oneYear()) == SimTime::zero() );
+    for(size_t i = 0; i < speciesIndex.size(); ++i)
+        species[i].shiftTime( offset );
+}
+
+void VectorModel::reseed( uint64_t seed1, uint64_t seed2 ){
+    m_rng.seed( seed1, seed2 );
+}
+
 void VectorModel::summarize () {
     TransmissionModel::summarize ();
     
@@ -63,6 +63,7 @@ public:
   virtual SimTime minPreinitDuration ();
   virtual SimTime expectedInitDuration ();
   virtual SimTime initIterate ();
+  virtual bool inFittingRound () const;
   
   virtual void vectorUpdate (const Population& population);
   virtual void update (const Population& population);
@@ -73,6 +74,8 @@ public:
   virtual void deployVectorPopInterv (size_t instance);
   virtual void deployVectorTrap( size_t instance, double number, SimTime lifespan );
   virtual void uninfectVectors();
+  virtual void shiftTime( SimTime offset );
+  virtual void reseed( uint64_t seed1, uint64_t seed2 );
   
   virtual void summarize ();
   
@@ -97,6 +100,25 @@ private:
   void ctsCbResAvailability (ostream& stream);
   void ctsCbResRequirements (ostream& stream);
   
+    /** Fit emergence with the mosquito model alone (--fast-vector-warmup).
+     * 
+     * In place of the fitting rounds simulated by initIterate(), the
+     * population sums saved over the last year of the human warm-up are
+     * replayed as a periodic input (humans are unaffected by mosquitoes
+     * while EIR is forced) until the mosquito state is periodic, then
+     * emergence is fitted as usual. If report, prints a convergence
+     * report. */
+    void fitEquilibrium (bool report);
+    
+    /** Print, per species, how much emergence rates differ from those in
+     * refEmergence, which is then cleared. ref describes refEmergence. */
+    void reportEmergenceChange (const char* ref);
+    
+    /** Advance all species over the years [now - nYears, now) using saved
+     * population sums, which must cover one year. Sums of S_v per species
+     * and year replayed are written to annualS_v. */
+    void replayYears (int nYears, vector<vector<double>>& annualS_v);
+  
     /// RNG used by the transmission model
     LocalRng m_rng;
   
@@ -122,11 +144,20 @@ private:
     util::vecDay2D<double> saved_sum_avail;
     util::vecDay2D<double> saved_sigma_df;
     util::vecDay3D<double> saved_sigma_dif;
-    vector<double> saved_sigma_dff;
+    util::vecDay2D<double> saved_sigma_dff;
   //@}
     
-    // Cache; no need to checkpoint
-    vector<double> sigma_dif_species;
+    // Cache, per species; no need to checkpoint
+    vector<vector<double>> sigma_dif_species;
+    
+    /** Emergence rate per species for comparison with the result of the
+     * classic fitting rounds (see reportEmergenceChange): with
+     * --vector-warmup-sample, fitted on the full population by
+     * fitEquilibrium(); with --fast-vector-warmup and --debug-vector-fitting,
+     * the fast fit, which classic rounds then check. Set and cleared during
+     * the transmission-init phase; a checkpoint there would just lose the
+     * report. */
+    vector<vector<double>> refEmergence;
   
   friend class PerHost;
   friend class AnophelesModelSuite;
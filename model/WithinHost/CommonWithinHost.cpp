@@ -22,14 +22,20 @@
 #include "WithinHost/CommonWithinHost.h"
 #include "WithinHost/Diagnostic.h"
 #include "WithinHost/Genotypes.h"
+#include "WithinHost/Infection/DummyInfection.h"
+#include "WithinHost/Infection/EmpiricalInfection.h"
+#include "WithinHost/Infection/MolineauxInfection.h"
+#include "WithinHost/Infection/PennyInfection.h"
 #include "WithinHost/Pathogenesis/PathogenesisModel.h"
 #include "util/errors.h"
 #include "util/AgeGroupInterpolation.h"
 #include "util/random.h"
 #include "util/StreamValidator.h"
+#include "util/ModelOptions.h"
 #include "schema/scenario.h"
 
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 
 using namespace std;
 
@@ -45,6 +51,13 @@ util::AgeGroupInterpolator massByAge;
 
 bool reportInfectedOrPatentInfected = false;
 
+template<class InfT>
+unique_ptr<WHInterface> createWithinHost( LocalRng& rng, double comorbidityFactor ){
+    return unique_ptr<WHInterface>( new CommonWithinHostImpl<InfT>( rng, comorbidityFactor ) );
+}
+// Set by init() according to the infection model
+unique_ptr<WHInterface> (* createModel) (LocalRng& rng, double comorbidityFactor) = 0;
+
 
 // -----  Initialization  -----
 
@@ -63,6 +76,21 @@ void CommonWithinHost::init( const scnXml::Scenario& scenario ){
         mon::isUsedM(mon::MHR_PATENT_INFECTIONS);
     
     PkPd::LSTMModel::init( scenario );
+    
+    if (util::ModelOptions::option (util::DUMMY_WITHIN_HOST_MODEL)) {
+        createModel = &createWithinHost<DummyInfection>;
+    } else if (util::ModelOptions::option (util::EMPIRICAL_WITHIN_HOST_MODEL)) {
+        createModel = &createWithinHost<EmpiricalInfection>;
+    } else if (util::ModelOptions::option (util::MOLINEAUX_WITHIN_HOST_MODEL)) {
+        createModel = &createWithinHost<MolineauxInfection>;
+    } else {
+        assert( util::ModelOptions::option (util::PENNY_WITHIN_HOST_MODEL) );
+        createModel = &createWithinHost<PennyInfection>;
+    }
+}
+
+unique_ptr<WHInterface> CommonWithinHost::create( LocalRng& rng, double comorbidityFactor ){
+    return createModel( rng, comorbidityFactor );
 }
 
 CommonWithinHost::CommonWithinHost( LocalRng& rng, double comorbidityFactor ) :
@@ -83,27 +111,22 @@ CommonWithinHost::CommonWithinHost( LocalRng& rng, double comorbidityFactor ) :
     } while( hetMassMultiplier < minHetMassMult );
 }
 
-CommonWithinHost::~CommonWithinHost() {
-    for( auto inf = infections.begin(); inf != infections.end(); ++inf ){
-        delete *inf;
-    }
-    infections.clear();
-}
+template<class InfT>
+CommonWithinHostImpl<InfT>::CommonWithinHostImpl( LocalRng& rng, double comorbidityFactor ) :
+        CommonWithinHost( rng, comorbidityFactor )
+{}
 
 // -----  Simple infection adders/removers  -----
 
-void CommonWithinHost::clearInfections( Treatments::Stages stage ){
-    for(auto inf = infections.begin(); inf != infections.end();) {
-        if( stage == Treatments::BOTH ||
-            (stage == Treatments::LIVER && !(*inf)->bloodStage()) ||
-            (stage == Treatments::BLOOD && (*inf)->bloodStage())
-        ){
-            delete *inf;
-            inf = infections.erase( inf );
-        }else{
-            ++inf;
-        }
-    }
+template<class InfT>
+void CommonWithinHostImpl<InfT>::clearInfections( Treatments::Stages stage ){
+    // remove_if keeps the remaining infections in order
+    infections.erase( std::remove_if( infections.begin(), infections.end(),
+        [stage]( const InfT& inf ){
+            return stage == Treatments::BOTH ||
+                (stage == Treatments::LIVER && !inf.bloodStage()) ||
+                (stage == Treatments::BLOOD && inf.bloodStage());
+        } ), infections.end() );
     numInfs = infections.size();
 }
 
@@ -113,14 +136,16 @@ void CommonWithinHost::treatPkPd(size_t schedule, size_t dosage, double age, dou
     double mass = massByAge.eval( age ) * hetMassMultiplier;
     pkpdModel.prescribe( schedule, dosage, age, mass, delay_d );
 }
-void CommonWithinHost::clearImmunity() {
-    for(auto inf = infections.begin(); inf != infections.end(); ++inf) {
-        (*inf)->clearImmunity();
+template<class InfT>
+void CommonWithinHostImpl<InfT>::clearImmunity() {
+    for( InfT& inf : infections ){
+        inf.clearImmunity();
     }
     m_cumulative_h = 0.0;
     m_cumulative_Y_lag = 0.0;
 }
-void CommonWithinHost::importInfection(LocalRng& rng){
+template<class InfT>
+void CommonWithinHostImpl<InfT>::importInfection(LocalRng& rng){
     if( numInfs < MAX_INFECTIONS ){
         m_cumulative_h += 1;
         numInfs += 1;
@@ -128,7 +153,7 @@ void CommonWithinHost::importInfection(LocalRng& rng){
         // should use initial frequencies to select genotypes.
         vector<double> weights( 0 );        // zero length: signal to use initial frequencies
         uint32_t genotype = Genotypes::sampleGenotype(rng, weights);
-        infections.push_back(createInfection(rng, genotype));
+        infections.emplace_back( rng, genotype );
     }
     assert( numInfs == static_cast<int>(infections.size()) );
 }
@@ -136,7 +161,8 @@ void CommonWithinHost::importInfection(LocalRng& rng){
 
 // -----  Density calculations  -----
 
-void CommonWithinHost::update(LocalRng& rng,
+template<class InfT>
+void CommonWithinHostImpl<InfT>::update(LocalRng& rng,
         int nNewInfs, vector<double>& genotype_weights,
         double ageInYears, double bsvFactor)
 {
@@ -147,7 +173,7 @@ void CommonWithinHost::update(LocalRng& rng,
     assert( numInfs>=0 && numInfs<=MAX_INFECTIONS );
     for( int i=0; i<nNewInfs; ++i ) {
         uint32_t genotype = Genotypes::sampleGenotype(rng, genotype_weights);
-        infections.push_back(createInfection (rng, genotype));
+        infections.emplace_back( rng, genotype );
     }
     assert( numInfs == static_cast<int>(infections.size()) );
     
@@ -169,26 +195,28 @@ void CommonWithinHost::update(LocalRng& rng,
         
         double sumLogDens = 0.0;
         
-        for(auto inf = infections.begin(); inf != infections.end();) {
+        // Expired infections are removed by moving each remaining infection
+        // down over them (keeping the order), then truncating.
+        size_t next = 0;        // index at which to keep the next infection
+        for( size_t i = 0; i < infections.size(); ++i ){
+            InfT& inf = infections[i];
             // Note: this is only one treatment model; there is also the PK/PD model
-            bool expires = ((*inf)->bloodStage() ? treatmentBlood : treatmentLiver);
+            bool expires = (inf.bloodStage() ? treatmentBlood : treatmentLiver);
             
             if( !expires ){     /* no expiry due to simple treatment model; do update */
-                const double drugFactor = pkpdModel.getDrugFactor(rng, *inf, body_mass);
-                const double immFactor = immunitySurvivalFactor(ageInYears, (*inf)->cumulativeExposureJ());
+                const double drugFactor = pkpdModel.getDrugFactor(rng, &inf, body_mass);
+                const double immFactor = immunitySurvivalFactor(ageInYears, inf.cumulativeExposureJ());
                 const double survivalFactor = survivalFactor_part * immFactor * drugFactor;
                 // update, may result in termination of infection:
-                expires = (*inf)->update(rng, survivalFactor, now, body_mass);
+                expires = inf.template updateAs<InfT>(rng, survivalFactor, now, body_mass);
             }
             
             if( expires ){
-                delete *inf;
-                inf = infections.erase(inf);        // inf points to next infection now so don't increment with ++inf
                 --numInfs;
             } else {
-                double density = (*inf)->getDensity();
+                double density = inf.getDensity();
                 totalDensity += density;
-                if( !(*inf)->isHrp2Deficient() ){
+                if( !inf.isHrp2Deficient() ){
                     hrp2Density += density;
                 }
                 timeStepMaxDensity = max(timeStepMaxDensity, density);
@@ -196,9 +224,11 @@ void CommonWithinHost::update(LocalRng& rng,
                     // Base 10 logarithms are usually used; +1 because it avoids negatives in output while having very little affect on high densities
                     sumLogDens += log10(1.0 + density);
                 }
-                ++inf;
+                if( next != i ) infections[next] = std::move( inf );
+                ++next;
             }
         }
+        infections.erase( infections.begin() + next, infections.end() );
         pkpdModel.decayDrugs (body_mass);
     }
     
@@ -215,8 +245,8 @@ void CommonWithinHost::update(LocalRng& rng,
     // Cache total density for infectiousness calculations
     int y_lag_i = sim::ts1().moduloSteps(y_lag_len);
     for( size_t g = 0; g < Genotypes::N(); ++g ) m_y_lag.at(y_lag_i, g) = 0.0;
-    for( auto inf = infections.begin(); inf != infections.end(); ++inf ){
-        m_y_lag.at( y_lag_i, (*inf)->genotype() ) += (*inf)->getDensity();
+    for( const InfT& inf : infections ){
+        m_y_lag.at( y_lag_i, inf.genotype() ) += inf.getDensity();
     }
 }
 
@@ -228,25 +258,30 @@ void CommonWithinHost::addProphylacticEffects(const vector<double>& pClearanceBy
 
 // -----  Summarize  -----
 
-// Used in summarizeInfs.
-vector<CommonInfection*> sortedInfs;
+// Used in summarizeInfs (per thread: see util/parallel.h).
+thread_local vector<const CommonInfection*> sortedInfs;
 struct InfGenotypeSorter {
-    bool operator() (CommonInfection* i, CommonInfection* j){
+    bool operator() (const CommonInfection* i, const CommonInfection* j){
         return i->genotype() < j->genotype();
     }
 } infGenotypeSorter;
 
-bool CommonWithinHost::summarize( Host::Human& human )const{
+void CommonWithinHost::summarizeCommon( Host::Human& human )const{
     pathogenesisModel->summarize( human );
     pkpdModel.summarize( human );
+}
+
+template<class InfT>
+bool CommonWithinHostImpl<InfT>::summarize( Host::Human& human )const{
+    summarizeCommon( human );
     
     if( infections.size() > 0 ){
         mon::reportStatMHI( mon::MHR_INFECTED_HOSTS, human, 1 );
         if( reportInfectedOrPatentInfected ){
-            for(auto inf = infections.begin(); inf != infections.end(); ++inf) {
-                uint32_t genotype = (*inf)->genotype();
+            for( const InfT& inf : infections ){
+                uint32_t genotype = inf.genotype();
                 mon::reportStatMHGI( mon::MHR_INFECTIONS, human, genotype, 1 );
-                if( diagnostics::monitoringDiagnostic().isPositive( human.rng(), (*inf)->getDensity(), std::numeric_limits<double>::quiet_NaN() ) ){
+                if( diagnostics::monitoringDiagnostic().isPositive( human.rng(), inf.getDensity(), std::numeric_limits<double>::quiet_NaN() ) ){
                     mon::reportStatMHGI( mon::MHR_PATENT_INFECTIONS, human, genotype, 1 );
                 }
             }
@@ -257,7 +292,8 @@ bool CommonWithinHost::summarize( Host::Human& human )const{
             // We don't sort in place since that would affect random number sampling
             // order when updating, and the monitoring system should not in my
             // opinion affect outputs (since it would make testing harder).
-            sortedInfs.assign( infections.begin(), infections.end() );
+            sortedInfs.clear();
+            for( const InfT& inf : infections ) sortedInfs.push_back( &inf );
             sort( sortedInfs.begin(), sortedInfs.end(), infGenotypeSorter );
             auto inf = sortedInfs.begin();
             while( inf != sortedInfs.end() ){
@@ -293,18 +329,27 @@ void CommonWithinHost::checkpoint (istream& stream) {
     WHFalciparum::checkpoint (stream);
     hetMassMultiplier & stream;
     pkpdModel & stream;
-    for(int i = 0; i < numInfs; ++i) {
-        infections.push_back (checkpointedInfection (stream));
-    }
-    assert( numInfs == static_cast<int>(infections.size()) );
 }
-
 void CommonWithinHost::checkpoint (ostream& stream) {
     WHFalciparum::checkpoint (stream);
     hetMassMultiplier & stream;
     pkpdModel & stream;
-    for(auto inf = infections.begin(); inf != infections.end(); ++inf) {
-        (**inf) & stream;
+}
+
+template<class InfT>
+void CommonWithinHostImpl<InfT>::checkpoint (istream& stream) {
+    CommonWithinHost::checkpoint (stream);
+    infections.reserve( numInfs );
+    for(int i = 0; i < numInfs; ++i) {
+        infections.emplace_back( stream );
+    }
+    assert( numInfs == static_cast<int>(infections.size()) );
+}
+template<class InfT>
+void CommonWithinHostImpl<InfT>::checkpoint (ostream& stream) {
+    CommonWithinHost::checkpoint (stream);
+    for( InfT& inf : infections ){
+        inf & stream;
     }
 }
 }
@@ -35,29 +35,27 @@ namespace OM { namespace WithinHost {
  * This is not used by the old Descriptive within-host
  * models, but encapsulates nearly all the within-host (non-infection) code
  * required by the Dummy and Empirical within-host models.
+ *
+ * Infections are stored by CommonWithinHostImpl, templated over the infection
+ * type; this class holds the rest.
  */
 class CommonWithinHost : public WHFalciparum
 {
 public:
     static void init(const scnXml::Scenario& scenario);
     
-    CommonWithinHost( LocalRng& rng, double comorbidityFactor );
-    virtual ~CommonWithinHost();
-    
-    
-    virtual void importInfection(LocalRng& rng);
+    /** Create a within-host model storing infections of the type selected
+     * by the model options (see CommonWithinHostImpl). */
+    static unique_ptr<WHInterface> create( LocalRng& rng, double comorbidityFactor );
     
     virtual void treatPkPd(size_t schedule, size_t dosage, double age, double delay_d);
-    virtual void clearImmunity();
-    
-    virtual void update (LocalRng& rng, int nNewInfs, vector<double>& genotype_weights,
-            double ageInYears, double bsvFactor);
     
     virtual void addProphylacticEffects(const vector<double>& pClearanceByTime);
     
     /** \brief Factory functions to create infections.
      *
-     * These allow creation of the correct type of infection in a generic manner.
+     * These allow creation of the correct type of infection in a generic
+     * manner outside of a within-host model (e.g. in unit tests).
      * 
      * The first variant is for creating a new infection, the second for loading
      * one from a checkpoint. */
@@ -66,27 +64,59 @@ public:
     static CommonInfection* (* checkpointedInfection) (istream& stream);
     //@}
     
-    virtual bool summarize( Host::Human& human )const;
-    
 protected:
-    virtual void clearInfections( Treatments::Stages stage );
+    CommonWithinHost( LocalRng& rng, double comorbidityFactor );
+    
+    /// Report the parts of summarize() not depending on infections
+    void summarizeCommon( Host::Human& human )const;
     
     virtual void checkpoint (istream& stream);
     virtual void checkpoint (ostream& stream);
     
-private:
     /// Multiplies the mean mass (for this age) as a heterogeneity factor.
     double hetMassMultiplier;
     
     /// Encapsulates drug code for each human
     PkPd::LSTMModel pkpdModel;
+};
+
+/** CommonWithinHost with infections of type InfT (one of the subclasses of
+ * CommonInfection).
+ *
+ * Infections are stored by value, in order, in a vector rather than as a
+ * list of separately allocated objects, and updated without virtual calls.
+ * Expired infections are removed without changing the order of the others,
+ * so random numbers are drawn in the same order as before.
+ *
+ * Only used via CommonWithinHost::create(); member functions are defined in
+ * CommonWithinHost.cpp. */
+template<class InfT>
+class CommonWithinHostImpl : public CommonWithinHost
+{
+public:
+    CommonWithinHostImpl( LocalRng& rng, double comorbidityFactor );
+    
+    virtual void importInfection(LocalRng& rng);
+    
+    virtual void clearImmunity();
+    
+    virtual void update (LocalRng& rng, int nNewInfs, vector<double>& genotype_weights,
+            double ageInYears, double bsvFactor);
     
+    virtual bool summarize( Host::Human& human )const;
+    
+protected:
+    virtual void clearInfections( Treatments::Stages stage );
+    
+    virtual void checkpoint (istream& stream);
+    virtual void checkpoint (ostream& stream);
+    
+private:
     /** The list of all infections this human has.
      *
      * Since infection models and within host models are very much intertwined,
      * the idea is that each WithinHostModel has its own list of infections. */
-    //TODO: better to template class over infection type than use dynamic type?
-    std::list<CommonInfection*> infections;
+    std::vector<InfT> infections;
 };
 
 } }
@@ -49,6 +49,10 @@ public:
 	Infection(genotype)
     {}
     virtual ~CommonInfection();
+    CommonInfection (CommonInfection&&) = default;
+    CommonInfection& operator= (CommonInfection&&) = default;
+    CommonInfection (const CommonInfection&) = default;
+    CommonInfection& operator= (const CommonInfection&) = default;
     //@}
     
     
@@ -66,6 +70,17 @@ public:
 	    return updateDensity( rng, survivalFactor, bsAge, body_mass );
     }
     
+    /** As update(), but calling InfT::updateDensity directly (without a
+     * virtual call). The dynamic type of this infection must be InfT. */
+    template<class InfT>
+    inline bool updateAs( LocalRng& rng, double survivalFactor, SimTime now, double body_mass ){
+	SimTime bsAge = now - m_startDate - s_latentP;
+	if( bsAge < SimTime::zero() )
+	    return false;
+	else
+	    return static_cast<InfT*>(this)->InfT::updateDensity( rng, survivalFactor, bsAge, body_mass );
+    }
+    
     map<size_t, double> Kn; // IC50^slope per drug type, if sampled
     
 protected:
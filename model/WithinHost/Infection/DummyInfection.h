@@ -39,8 +39,6 @@ public:
     //! Constructor
     DummyInfection (LocalRng& rng, uint32_t protID);
     
-    virtual ~DummyInfection () {}
-    
     static void init ();
     
     virtual bool updateDensity( LocalRng& rng, double survivalFactor, SimTime bsAge, double );
@@ -41,12 +41,7 @@ public:
   /// For checkpointing (don't use for anything else)
   EmpiricalInfection(istream& stream);
   /// Per instance initialisation; create new inf.
-  EmpiricalInfection(LocalRng& rng, uint32_t protID, double growthRateMultiplier);
-  /** Destructor
-   * 
-   * Note: this destructor does nothing in order to allow shallow copying to
-   * the population list. */
-  virtual ~EmpiricalInfection() {}
+  EmpiricalInfection(LocalRng& rng, uint32_t protID, double growthRateMultiplier = 1.0);
   //@}
   
   /// Set patent growth rate multiplier.
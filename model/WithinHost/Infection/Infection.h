@@ -50,6 +50,11 @@ public:
         m_genotype & stream;
     }
     virtual ~Infection () {}
+    // Infections of CommonWithinHost are stored by value and moved
+    Infection (Infection&&) = default;
+    Infection& operator= (Infection&&) = default;
+    Infection (const Infection&) = default;
+    Infection& operator= (const Infection&) = default;
     
     
     /** Return true if infection is blood stage.
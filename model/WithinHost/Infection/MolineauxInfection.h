@@ -54,7 +54,6 @@ public:
     MolineauxInfection(LocalRng& rng, uint32_t protID);
     // Load from a checkpoint:
     MolineauxInfection (istream& stream);
-    virtual ~MolineauxInfection () {};
     
     virtual bool updateDensity( LocalRng& rng, double survivalFactor, SimTime bsAge, double body_mass );
     
@@ -39,8 +39,6 @@ public:
     PennyInfection(LocalRng& rng, uint32_t protID);
     /// Resume from a checkpoint
     PennyInfection (istream& stream);
-    /// Destructor
-    virtual ~PennyInfection () {};
     
     virtual bool updateDensity( LocalRng& rng, double survivalFactor, SimTime bsAge, double );
     
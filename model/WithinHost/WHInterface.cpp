@@ -95,7 +95,7 @@ unique_ptr<WHInterface> WHInterface::createWithinHostModel(LocalRng& rng, double
     if( opt_vivax_simple ) {
         return unique_ptr<WHInterface>(new WHVivax( rng, comorbidityFactor ));
     } else if( opt_common_whm ) {
-        return unique_ptr<WHInterface>(new CommonWithinHost( rng, comorbidityFactor ));
+        return CommonWithinHost::create( rng, comorbidityFactor );
     } else {
         return unique_ptr<WHInterface>(new DescriptiveWithinHostModel( rng, comorbidityFactor ));
     }
@@ -23,6 +23,7 @@
 
 #include "Global.h"
 #include "util/random.h"
+#include "util/arena.h"
 #include "WithinHost/Diagnostic.h"
 #include "WithinHost/Pathogenesis/State.h"
 #include "Parameters.h"
@@ -73,7 +74,7 @@ private:
  * (i.e. assuming successful innoculation), including some drug action code,
  * and outputting parasite densities.
  */
-class WHInterface {
+class WHInterface : public util::ArenaObject {
 public:
     /// @brief Static methods
     //@{
@@ -29,6 +29,7 @@
 #include "Transmission/TransmissionModel.h"
 #include "util/random.h"
 #include <schema/interventions.h>
+#include <algorithm>
 
 namespace OM { namespace interventions {
 
@@ -204,14 +205,20 @@ public:
     }
     
     virtual void deploy (Population& population, Transmission::TransmissionModel& transmission) {
-        for(Human& human : population) {
-            SimTime age = human.age(sim::now());
-            if( age >= minAge && age < maxAge ){
-                if( subPop == ComponentId::wholePop() || (human.isInSubPop( subPop ) != complement) ){
-                    if( human.rng().bernoulli( coverage ) ){
-                        deployToHuman( human, mon::Deploy::TIMED );
-                    }
-                }
+        vector<Human*> eligible;
+        vector<util::LocalRng*> rngs;
+        forEachEligible( population, [&]( Human& human ){
+            eligible.push_back( &human );
+            rngs.push_back( &human.rng() );
+        } );
+        // Sample compliance for all eligible humans at once. Each draw is the
+        // same as human.rng().bernoulli( coverage ) since humans have
+        // independent RNGs.
+        unique_ptr<bool[]> comply( new bool[eligible.size()] );
+        util::LocalRng::bernoulli_each( rngs.data(), coverage, comply.get(), eligible.size() );
+        for( size_t i = 0; i < eligible.size(); ++i ){
+            if( comply[i] ){
+                deployToHuman( *eligible[i], mon::Deploy::TIMED );
             }
         }
     }
@@ -226,6 +233,35 @@ public:
     }
     
 protected:
+    /** Call f(human) for each human within the age range and, if restricted,
+     * in (or with complement, not in) subPop, in population order.
+     * 
+     * Only the age range is visited (see Population::ageRange). Without
+     * complement, only candidate members of subPop are visited (see
+     * Population::subPopCandidates). */
+    template<class F>
+    void forEachEligible( Population& population, F f ){
+        pair<Population::Iter, Population::Iter> range = population.ageRange( minAge, maxAge );
+        if( subPop == ComponentId::wholePop() ){
+            for( Population::Iter it = range.first; it != range.second; ++it ){
+                f( *it );
+            }
+        }else if( complement ){
+            for( Population::Iter it = range.first; it != range.second; ++it ){
+                if( !it->isInSubPop( subPop ) ) f( *it );
+            }
+        }else{
+            const size_t first = range.first - population.begin();
+            const size_t last = range.second - population.begin();
+            const vector<size_t>& members = population.subPopCandidates( subPop );
+            for( auto it = std::lower_bound( members.begin(), members.end(), first );
+                    it != members.end() && *it < last; ++it ){
+                Human& human = population.begin()[*it];
+                if( human.isInSubPop( subPop ) ) f( human );
+            }
+        }
+    }
+    
     // restrictions on deployment
     SimTime minAge, maxAge;
 };
@@ -255,16 +291,11 @@ public:
         // Cumulative case: bring target group's coverage up to target coverage
         vector<Host::Human*> unprotected;
         size_t total = 0;       // number of humans within age bound and optionally subPop
-        for(Population::Iter iter = population.begin(); iter != population.end(); ++iter) {
-            SimTime age = iter->age(sim::now());
-            if( age >= minAge && age < maxAge ){
-                if( subPop == ComponentId::wholePop() || (iter->isInSubPop( subPop ) != complement) ){
-                    total+=1;
-                    if( !iter->isInSubPop(cumCovInd) )
-                        unprotected.push_back( &*iter );
-                }
-            }
-        }
+        forEachEligible( population, [&]( Human& human ){
+            total+=1;
+            if( !human.isInSubPop(cumCovInd) )
+                unprotected.push_back( &human );
+        } );
         
         if( total == 0 ) return;        // no humans to deploy to; avoid divide by zero
         double propProtected = static_cast<double>( total - unprotected.size() ) / static_cast<double>( total );
@@ -64,6 +64,10 @@ void GVIComponent::deploy( Host::Human& human, mon::Deploy::Method method, Vacci
     mon::reportEventMHD( mon::MHD_GVI, human, method );
 }
 
+void GVIComponent::clearComponents(){
+    componentsByIndex.clear();
+}
+
 Component::Type GVIComponent::componentType()const{ return Component::GVI; }
 
 void GVIComponent::print_details( std::ostream& out )const{
@@ -137,6 +141,22 @@ double HumanGVI::relFecundity(size_t speciesIndex) const{
     return anoph.byProtection( effect );
 }
 
+void HumanGVI::multiplyFactors( vector<Transmission::SpeciesFactors>& factors ) const{
+    const GVIComponent& params = *GVIComponent::componentsByIndex[m_id.id];
+    const double effectSurvival = getEffectSurvival(params);
+    for( size_t s = 0; s < factors.size(); ++s ){
+        const GVIComponent::GVIAnopheles& anoph = params.species[s];
+        factors[s].availability *= anoph.byProtection(
+            1.0 - anoph.deterrency * effectSurvival );
+        factors[s].probBiting *= anoph.byProtection(
+            1.0 - anoph.preprandialKilling * effectSurvival );
+        factors[s].probResting *= anoph.byProtection(
+            1.0 - anoph.postprandialKilling * effectSurvival );
+        factors[s].fecundity *= anoph.byProtection(
+            1.0 - anoph.fecundityReduction * effectSurvival );
+    }
+}
+
 void HumanGVI::checkpoint( ostream& stream ){
     deployTime & stream;
     decayHet & stream;
@@ -69,6 +69,10 @@ void IRSComponent::deploy( Host::Human& human, mon::Deploy::Method method, Vacci
     mon::reportEventMHD( mon::MHD_IRS, human, method );
 }
 
+void IRSComponent::clearComponents(){
+    componentsByIndex.clear();
+}
+
 Component::Type IRSComponent::componentType()const{ return Component::IRS; }
 
 void IRSComponent::print_details( std::ostream& out )const{
@@ -279,6 +283,22 @@ double HumanIRS::relFecundity(size_t speciesIndex) const{
     return anoph.byProtection( effect );
 }
 
+void HumanIRS::multiplyFactors( vector<Transmission::SpeciesFactors>& factors ) const{
+    const IRSComponent& params = *IRSComponent::componentsByIndex[m_id.id];
+    const double insecticideContent = getInsecticideContent(params);
+    for( size_t s = 0; s < factors.size(); ++s ){
+        const IRSComponent::IRSAnopheles& anoph = params.species[s];
+        factors[s].availability *= anoph.byProtection(
+            anoph.relativeAttractiveness( insecticideContent ) );
+        factors[s].probBiting *= anoph.byProtection(
+            anoph.preprandialSurvivalFactor( insecticideContent ) );
+        factors[s].probResting *= anoph.byProtection(
+            anoph.postprandialSurvivalFactor( insecticideContent ) );
+        factors[s].fecundity *= anoph.byProtection(
+            anoph.fecundityEffect( insecticideContent ) );
+    }
+}
+
 void HumanIRS::checkpoint( ostream& stream ){
     deployTime & stream;
     initialInsecticide & stream;
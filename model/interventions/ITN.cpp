@@ -538,6 +538,10 @@ void ITNComponent::deploy( Host::Human& human, mon::Deploy::Method method, Vacci
     mon::reportEventMHD( mon::MHD_ITN, human, method );
 }
 
+void ITNComponent::clearComponents(){
+    componentsByIndex.clear();
+}
+
 Component::Type ITNComponent::componentType() const{
     return Component::ITN;
 }
@@ -702,6 +706,19 @@ double HumanITN::relFecundity(size_t speciesIndex) const{
     return anoph.relFecundity( holeIndex, getInsecticideContent(params) );
 }
 
+void HumanITN::multiplyFactors( vector<Transmission::SpeciesFactors>& factors ) const{
+    if( deployTime == SimTime::never() ) return;
+    const ITNComponent& params = *ITNComponent::componentsByIndex[m_id.id];
+    const double insecticideContent = getInsecticideContent(params);
+    for( size_t s = 0; s < factors.size(); ++s ){
+        const ITNComponent::ITNAnopheles& anoph = params.species[s];
+        factors[s].availability *= anoph.relativeAttractiveness( holeIndex, insecticideContent );
+        factors[s].probBiting *= anoph.preprandialSurvivalFactor( holeIndex, insecticideContent );
+        factors[s].probResting *= anoph.postprandialSurvivalFactor( holeIndex, insecticideContent );
+        factors[s].fecundity *= anoph.relFecundity( holeIndex, insecticideContent );
+    }
+}
+
 void HumanITN::checkpoint( ostream& stream ){
     deployTime & stream;
     disposalTime & stream;
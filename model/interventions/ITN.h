@@ -160,6 +160,9 @@ public:
     virtual unique_ptr<PerHostInterventionData> makeHumanPart(LocalRng& rng) const;
     virtual unique_ptr<PerHostInterventionData> makeHumanPart( istream& stream, ComponentId id ) const;
     
+    /// Forget all components (before interventions are re-initialised)
+    static void clearComponents();
+    
 private:
     /** Per mosquito-species parameters for extended ITN model. */
     class ITNAnopheles {
@@ -257,6 +260,7 @@ public:
     virtual double postprandialSurvivalFactor(size_t speciesIndex) const;
     /// Get the mosquito fecundity multiplier (1 for no effect).
     virtual double relFecundity(size_t speciesIndex) const;
+    virtual void multiplyFactors( vector<Transmission::SpeciesFactors>& factors ) const;
     
 protected:
     virtual void checkpoint( ostream& stream );
@@ -20,6 +20,7 @@
 
 #include "interventions/InterventionManager.hpp"
 #include "Population.h"
+#include "SimContext.h"
 #include "util/CommandLine.h"
 #include "util/timeConversions.h"
 #include "interventions/GVI.h"
@@ -41,7 +42,6 @@ std::map<std::string,ComponentId> InterventionManager::identifierMap;
 vector<unique_ptr<HumanInterventionComponent>> InterventionManager::humanComponents;
 vector<ContinuousHumanDeployment> InterventionManager::continuous;
 vector<unique_ptr<TimedDeployment>> InterventionManager::timed;
-uint32_t InterventionManager::nextTimed;
 OM::Host::ImportedInfections InterventionManager::importedInfections;
 
 // declared in HumanComponents.h:
@@ -50,8 +50,58 @@ vector<ComponentId> removeAtIds[SubPopRemove::NUM];
 // static functions:
 
 void InterventionManager::init (const scnXml::Interventions& intervElt, Transmission::TransmissionModel& transmission){
-    nextTimed = 0;
+    SimContext::current().nextTimed = 0;
     
+    initHuman( intervElt );
+    
+    if( intervElt.getUninfectVectors().present() ){
+        const scnXml::UninfectVectors& elt = intervElt.getUninfectVectors().get();
+        if( elt.getTimedDeployment().size() > 0 ){
+            // timed deployments:
+            for( auto it = elt.getTimedDeployment().begin(); it != elt.getTimedDeployment().end(); ++it ){
+                SimDate date = UnitParse::readDate(it->getTime(), UnitParse::STEPS /*STEPS is only for backwards compatibility*/);
+                timed.push_back( unique_ptr<TimedDeployment>(new TimedUninfectVectorsDeployment( date )) );
+            }
+        }
+    }
+    if( intervElt.getVectorPop().present() ){
+        typedef scnXml::VectorPop::InterventionSequence SeqT;
+        const SeqT& seq = intervElt.getVectorPop().get().getIntervention();
+        size_t instance = 0;
+        for( auto it = seq.begin(), end = seq.end(); it != end; ++it ){
+            const scnXml::VectorIntervention& elt = *it;
+            if (elt.getTimed().present() ) {
+                transmission.initVectorInterv( elt.getDescription().getAnopheles(), instance, elt.getName() );
+                
+                const scnXml::TimedBaseList::DeploySequence& seq = elt.getTimed().get().getDeploy();
+                for( auto it = seq.begin(); it != seq.end(); ++it ) {
+                    SimDate date = UnitParse::readDate(it->getTime(), UnitParse::STEPS /*STEPS is only for backwards compatibility*/);
+                    timed.push_back( unique_ptr<TimedDeployment>(new TimedVectorDeployment( date, instance )) );
+                }
+                instance++;
+            }
+        }
+    }
+    if( intervElt.getVectorTrap().present() ){
+        size_t instance = 0;
+        foreach( const scnXml::VectorTrap& trap, intervElt.getVectorTrap().get().getIntervention() ){
+            transmission.initVectorTrap(trap.getDescription(), instance, trap.getName());
+            if( trap.getTimed().present() ) {
+                foreach( const scnXml::Deploy1 deploy, trap.getTimed().get().getDeploy() ){
+                    SimDate date = UnitParse::readDate(deploy.getTime(), UnitParse::STEPS);
+                    double ratio = deploy.getRatioToHumans();
+                    SimTime lifespan = UnitParse::readDuration(deploy.getLifespan(), UnitParse::NONE);
+                    timed.push_back( unique_ptr<TimedDeployment>(new TimedTrapDeployment( date, instance, ratio, lifespan )) );
+                }
+            }
+            instance += 1;
+        }
+    }
+    
+    finishInit();
+}
+
+void InterventionManager::initHuman (const scnXml::Interventions& intervElt){
     if( intervElt.getChangeHS().present() ){
         const scnXml::ChangeHS& chs = intervElt.getChangeHS().get();
         if( chs.getTimedDeployment().size() > 0 ){
@@ -279,50 +329,9 @@ void InterventionManager::init (const scnXml::Interventions& intervElt, Transmis
         }
 #endif
     }
-    if( intervElt.getUninfectVectors().present() ){
-        const scnXml::UninfectVectors& elt = intervElt.getUninfectVectors().get();
-        if( elt.getTimedDeployment().size() > 0 ){
-            // timed deployments:
-            for( auto it = elt.getTimedDeployment().begin(); it != elt.getTimedDeployment().end(); ++it ){
-                SimDate date = UnitParse::readDate(it->getTime(), UnitParse::STEPS /*STEPS is only for backwards compatibility*/);
-                timed.push_back( unique_ptr<TimedDeployment>(new TimedUninfectVectorsDeployment( date )) );
-            }
-        }
-    }
-    if( intervElt.getVectorPop().present() ){
-        typedef scnXml::VectorPop::InterventionSequence SeqT;
-        const SeqT& seq = intervElt.getVectorPop().get().getIntervention();
-        size_t instance = 0;
-        for( auto it = seq.begin(), end = seq.end(); it != end; ++it ){
-            const scnXml::VectorIntervention& elt = *it;
-            if (elt.getTimed().present() ) {
-                transmission.initVectorInterv( elt.getDescription().getAnopheles(), instance, elt.getName() );
-                
-                const scnXml::TimedBaseList::DeploySequence& seq = elt.getTimed().get().getDeploy();
-                for( auto it = seq.begin(); it != seq.end(); ++it ) {
-                    SimDate date = UnitParse::readDate(it->getTime(), UnitParse::STEPS /*STEPS is only for backwards compatibility*/);
-                    timed.push_back( unique_ptr<TimedDeployment>(new TimedVectorDeployment( date, instance )) );
-                }
-                instance++;
-            }
-        }
-    }
-    if( intervElt.getVectorTrap().present() ){
-        size_t instance = 0;
-        foreach( const scnXml::VectorTrap& trap, intervElt.getVectorTrap().get().getIntervention() ){
-            transmission.initVectorTrap(trap.getDescription(), instance, trap.getName());
-            if( trap.getTimed().present() ) {
-                foreach( const scnXml::Deploy1 deploy, trap.getTimed().get().getDeploy() ){
-                    SimDate date = UnitParse::readDate(deploy.getTime(), UnitParse::STEPS);
-                    double ratio = deploy.getRatioToHumans();
-                    SimTime lifespan = UnitParse::readDuration(deploy.getLifespan(), UnitParse::NONE);
-                    timed.push_back( unique_ptr<TimedDeployment>(new TimedTrapDeployment( date, instance, ratio, lifespan )) );
-                }
-            }
-            instance += 1;
-        }
-    }
+}
 
+void InterventionManager::finishInit (){
     // lists must be sorted, increasing
     // For reproducability, we need to use stable_sort, not sort.
     stable_sort(continuous.begin(), continuous.end(), byDeployTime);
@@ -353,6 +362,40 @@ void InterventionManager::init (const scnXml::Interventions& intervElt, Transmis
     }
 }
 
+void InterventionManager::initBranch (const scnXml::Interventions& intervElt){
+    assert( SimContext::current().nextTimed == 0 );
+    // Keep vector deployments in their original (insertion) order. These
+    // were inserted after all others and sorting is stable, so the list is
+    // then sorted exactly as init() would sort it.
+    vector<unique_ptr<TimedDeployment>> vectorTimed;
+    for( auto& deployment : timed ){
+        TimedDeployment *d = deployment.get();
+        if( dynamic_cast<TimedUninfectVectorsDeployment*>(d) != 0 ||
+            dynamic_cast<TimedVectorDeployment*>(d) != 0 ||
+            dynamic_cast<TimedTrapDeployment*>(d) != 0 )
+        {
+            vectorTimed.push_back( move(deployment) );
+        }
+    }
+    timed.clear();
+    continuous.clear();
+    identifierMap.clear();
+    humanComponents.clear();
+    for( size_t i = 0; i < SubPopRemove::NUM; ++i )
+        removeAtIds[i].clear();
+    VaccineComponent::clearComponents();
+    ITNComponent::clearComponents();
+    IRSComponent::clearComponents();
+    GVIComponent::clearComponents();
+    importedInfections = Host::ImportedInfections();
+    
+    initHuman( intervElt );
+    for( auto& deployment : vectorTimed )
+        timed.push_back( move(deployment) );
+    finishInit();
+}
+
+
 ComponentId InterventionManager::getComponentId( const string textId )
 {
     auto it = identifierMap.find( textId );
@@ -373,6 +416,7 @@ void InterventionManager::loadFromCheckpoint(
     // We need to re-deploy changeHS and changeEIR interventions, but nothing
     // else. nextTimed should be zero so we can go through all past interventions.
     // Only redeploy those which happened before this time step.
+    uint32_t& nextTimed = SimContext::current().nextTimed;
     assert( nextTimed == 0 );
     while( timed[nextTimed]->date < date ){
         TimedDeployment *deployment = &*timed[nextTimed];
@@ -397,6 +441,7 @@ void InterventionManager::deploy(Population& population, Transmission::Transmiss
     
     // deploy timed interventions
     SimDate now = sim::intervDate();
+    uint32_t& nextTimed = SimContext::current().nextTimed;
     while( timed[nextTimed]->date <= now ){
         timed[nextTimed]->deploy( population, transmission );
         nextTimed += 1;
@@ -43,12 +43,21 @@ public:
     /** Read XML descriptions. */
     static void init (const scnXml::Interventions& intervElt, Transmission::TransmissionModel& transmission);
     
+    /** Replace the human interventions, changeHS, changeEIR and imported
+     * infections with those of intervElt, keeping vector interventions.
+     * 
+     * For use at the start of the main phase only (when nothing has been
+     * deployed yet), by simulations branching from a shared warm-up.
+     * Vector interventions (which configure the transmission model) must be
+     * the same as in the element passed to init(). */
+    static void initBranch (const scnXml::Interventions& intervElt);
+    
     /// Checkpointing
     template<class S>
     static void checkpoint (S& stream) {
         using namespace OM::util::checkpoint;
         // most members are only set from XML,
-        // nextTimed varies but is re-set by loadFromCheckpoint
+        // SimContext::nextTimed varies but is re-set by loadFromCheckpoint
         importedInfections & stream;
     }
 
@@ -83,6 +92,11 @@ public:
     static ComponentId getComponentId( const std::string textId );
     
 private:
+    // Read changeHS, changeEIR, human and importedInfections elements
+    static void initHuman (const scnXml::Interventions& intervElt);
+    // Sort deployment lists and add end marker
+    static void finishInit ();
+    
     // Map of textual identifiers to numeric identifiers for components
     static std::map<std::string,ComponentId> identifierMap;
     // All human intervention components, indexed by a number. This list is used
@@ -91,8 +105,9 @@ private:
     // Continuous interventions, sorted by deployment age (weakly increasing)
     static vector<ContinuousHumanDeployment> continuous;
     // List of all timed interventions. Should be sorted (time weakly increasing).
+    // The index of the next to deploy is SimContext::nextTimed (not
+    // checkpointed; see loadFromCheckpoint).
     static vector<unique_ptr<TimedDeployment>> timed;
-    static uint32_t nextTimed;  // not chcekpointed (see loadFromCheckpoint)
     
     // imported infections are not really interventions, and handled by a separate class
     // (but are grouped here for convenience and due toassociation in schema)
@@ -73,6 +73,11 @@ void VaccineComponent::deploy(Host::Human& human, mon::Deploy::Method method, Va
     else assert( false );
 }
 
+void VaccineComponent::clearComponents(){
+    params.clear();
+    reportComponent = ComponentId::wholePop();
+}
+
 Component::Type VaccineComponent::componentType() const
 {
     if( type == Vaccine::PEV ) return Component::PEV;
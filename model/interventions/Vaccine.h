@@ -49,6 +49,9 @@ public:
     
     virtual void print_details( std::ostream& out )const;
     
+    /// Forget all components (before interventions are re-initialised)
+    static void clearComponents();
+    
 private:
     /** Get the initial efficacy of the vaccine.
      *
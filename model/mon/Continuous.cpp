@@ -31,6 +31,10 @@
 #include <vector>
 #include <map>
 #include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <boost/format.hpp>
 #include <gzstream/gzstream.h>
 
@@ -49,6 +53,10 @@ namespace OM { namespace mon {
      * reload a streampos and use on a new file. */
     streamoff streamOff;
     streampos streamStart;
+    /// Header (titles) written at the start of the file
+    string ctsHeader;
+    /// Each line of output is formatted here before being passed to writer
+    ostringstream ctsLine;
     
     // List of all registered callbacks (not used after init() runs)
     class Callback {
@@ -86,9 +94,58 @@ namespace OM { namespace mon {
     bool duringInit = false;
     
     
+    /* Lines are formatted on the simulation thread and written to ctsOStream
+     * by a background thread, so that the simulation does not wait on the
+     * file system each reporting step. The writer thread flushes after each
+     * batch it writes (so readers only see whole lines); while it runs, no
+     * other thread may use ctsOStream. It starts on first use and is stopped
+     * by sync(). */
+    namespace writer {
+        mutex lock;
+        condition_variable cond;
+        string pending;     // lines not yet passed to ctsOStream
+        bool stop = false;
+        thread worker;
+        
+        void run(){
+            unique_lock<mutex> l( lock );
+            while( true ){
+                cond.wait( l, []{ return stop || !pending.empty(); } );
+                if( pending.empty() ) break;    // stopped and all written
+                string batch;
+                batch.swap( pending );
+                l.unlock();
+                ctsOStream.write( batch.data(), batch.size() );
+                ctsOStream.flush();
+                l.lock();
+            }
+        }
+        void push( const string& line ){
+            {
+                lock_guard<mutex> l( lock );
+                pending.append( line );
+            }
+            if( !worker.joinable() )
+                worker = thread( run );
+            cond.notify_one();
+        }
+        void finish(){
+            if( !worker.joinable() ) return;
+            {
+                lock_guard<mutex> l( lock );
+                stop = true;
+            }
+            cond.notify_one();
+            worker.join();
+            stop = false;
+        }
+    }
+    
+    // Must be defined after writer (destroyed first)
     ContinuousType Continuous;
     
     ContinuousType::~ContinuousType (){
+        writer::finish();
         // free memory
         toReport.clear();
         for( auto it = registered.begin(); it != registered.end(); ++it )
@@ -114,14 +171,18 @@ namespace OM { namespace mon {
 	
         if( ctsOpt.get().getDuringInit().present() )
             duringInit = ctsOpt.get().getDuringInit().get();
+        if( duringInit && !util::CommandLine::getBranches().empty() ){
+            // each branch restarts ctsout at the start of the main phase (see redirect)
+            throw xml_scenario_error( "monitoring/continuous/duringInit may not be used along with --branch" );
+        }
         
         cts_filename = util::CommandLine::getCtsoutName();
         
 	// This locale ensures uniform formatting of nans and infs on all platforms.
 	locale old_locale;
 	locale nfn_put_locale(old_locale, new boost::math::nonfinite_num_put<char>);
-	ctsOStream.imbue( nfn_put_locale );
-	ctsOStream.width (0);
+	ctsLine.imbue( nfn_put_locale );
+	ctsLine.width (0);
 	
 	if( isCheckpoint ){
 	    scnXml::OptionSet::OptionSequence sOSeq = ctsOpt.get().getOption();
@@ -143,32 +204,55 @@ namespace OM { namespace mon {
 	    streamStart = ctsOStream.tellp();
 	    // we set position later, in staticCheckpoint
 	}else{
-	    ctsOStream.open( cts_filename.c_str(), ios::binary|ios::out );
-	    streamStart = ctsOStream.tellp();
-	    ctsOStream << "##\t##" << endl;	// live-graph needs a deliminator specifier when it's not a comma
+	    ostringstream header;
+	    header << "##\t##" << endl;	// live-graph needs a deliminator specifier when it's not a comma
 	    
 	    if( duringInit )
-                ctsOStream << "simulation time\t";
-	    ctsOStream << "timestep";   //TODO: change to days or remove or leave?
+                header << "simulation time\t";
+	    header << "timestep";   //TODO: change to days or remove or leave?
 	    scnXml::OptionSet::OptionSequence sOSeq = ctsOpt.get().getOption();
 	    for(scnXml::OptionSet::OptionConstIterator it = sOSeq.begin(); it != sOSeq.end(); ++it) {
 		auto reg_it = registered.find( it->getName() );
 		if( reg_it == registered.end() )
 		    throw xml_scenario_error( (boost::format("monitoring.continuous: no output \"%1%\"") %it->getName() ).str() );
 		if( it->getValue() ){
-		    ctsOStream << reg_it->second->titles;
+		    header << reg_it->second->titles;
 		    toReport.push_back( reg_it->second );
 		}
 	    }
-	    ctsOStream << mon::lineEnd << flush;
-	    streamOff = ctsOStream.tellp() - streamStart;
+	    header << mon::lineEnd;
+	    ctsHeader = header.str();
+	    openNew();
 	}
     }
-
+    
+    void ContinuousType::openNew (){
+        ctsOStream.open( cts_filename.c_str(), ios::binary|ios::out );
+        streamStart = ctsOStream.tellp();
+        ctsOStream << ctsHeader << flush;
+        streamOff = ctsOStream.tellp() - streamStart;
+    }
+    
+    void ContinuousType::redirect (const string& filename){
+        if( ctsPeriod == SimTime::zero() )
+            return;	// output disabled
+        assert( !duringInit );  // would lose output written so far; rejected by init
+        sync();
+        ctsOStream.close();
+        cts_filename = filename;
+        openNew();
+    }
+    
+    void ContinuousType::sync (){
+        writer::finish();
+    }
+    
     void ContinuousType::checkpoint (ostream& stream){
         if( ctsPeriod == SimTime::zero() )
             return;	// output disabled
 	
+        // The file must contain everything up to streamOff:
+        sync();
 	streamOff & stream;
     }
     void ContinuousType::checkpoint (istream& stream){
@@ -210,22 +294,24 @@ namespace OM { namespace mon {
         } else {
             if( mod_nn(sim::now(), ctsPeriod) != SimTime::zero() )
                 return;
-            ctsOStream << sim::now().inSteps() << '\t';
+            ctsLine << sim::now().inSteps() << '\t';
         }
 	
         if( duringInit && sim::intervTime() < SimTime::zero() ){
-            ctsOStream << "nan";
+            ctsLine << "nan";
         }else{
             // NOTE: we could switch this to output dates, but (1) it would be
             // breaking change and (2) it may be harder to use.
-            ctsOStream << sim::intervTime().inSteps();
+            ctsLine << sim::intervTime().inSteps();
         }
 	for( size_t i = 0; i < toReport.size(); ++i )
-	    toReport[i]->call( population, ctsOStream );
-	// We must flush often to avoid temporarily outputting partial lines
-	// (resulting in incorrect real-time graphs).
-	ctsOStream << mon::lineEnd << flush;
+	    toReport[i]->call( population, ctsLine );
+	ctsLine << mon::lineEnd;
 	
-	streamOff = ctsOStream.tellp() - streamStart;
+	// Hand the whole line to the writer (which never writes partial lines)
+	const string line = ctsLine.str();
+	writer::push( line );
+	streamOff += line.size();
+	ctsLine.str( string() );
     }
 } }
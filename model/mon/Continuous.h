@@ -50,6 +50,20 @@ namespace mon {
 	 * Callbacks should be registered before init() is called. */
 	void init (const scnXml::Monitoring& monitoring, bool isCheckpoint);
         
+        /** Close the output file and restart output (from the header) in a
+         * new file.
+         * 
+         * Only valid if no output has been written yet other than the header
+         * (i.e. not during initialisation); used by simulations branching
+         * from a shared warm-up. */
+        void redirect (const string& filename);
+        
+        /** Wait until all output generated so far has been written to the
+         * file. Output is written by a background thread; this stops that
+         * thread (it restarts on the next update()), which must be done
+         * before fork() and before the program exits. */
+        void sync ();
+        
         /// Checkpointing
         template<class S>
         void operator& (S& stream) {
@@ -77,6 +91,8 @@ namespace mon {
 	void update (const Population& population);
         
     private:
+        // Open cts_filename and write the header
+        void openNew();
         void checkpoint(ostream& stream);
         void checkpoint(istream& stream);
     };
@@ -22,6 +22,7 @@
 #define H_OM_mon_info
 
 #include "Global.h"     // SimTime
+#include "SimContext.h"
 
 #include <string>
 #include <boost/integer_traits.hpp>
@@ -34,10 +35,8 @@ namespace impl {
     // Consts (set during program start-up):
     extern size_t nSurveys;     // number of reported surveys
     extern size_t nCohorts;
-    // Variables (checkpointed):
-    extern bool isInit; // set true after "initialisation" survey at intervention time 0
-    extern size_t survNumEvent, survNumStat;
-    extern SimDate nextSurveyDate;
+    // Variables (checkpointed) are in SimContext: monIsInit is set true after
+    // the "initialisation" survey at intervention time 0.
 }
 
 /// For surveys and measures to say something shouldn't be reported
@@ -48,18 +47,21 @@ const char lineEnd = '\n';
 
 /// The current survey number (can be passed back to 'event' report functions taking
 /// survey times). May have the special value NOT_USED.
-inline size_t eventSurveyNumber(){ return impl::survNumEvent; }
+inline size_t eventSurveyNumber(){ return SimContext::current().monSurvNumEvent; }
 
 /// Whether the current survey is reported.
 /// 
 /// Exception: there is a dummy survey at intervention time 0 which is not
 /// reported but acts like it is to set survey variables.
-inline bool isReported(){ return !impl::isInit || impl::survNumStat != NOT_USED; }
+inline bool isReported(){
+    const SimContext& ctx = SimContext::current();
+    return !ctx.monIsInit || ctx.monSurvNumStat != NOT_USED;
+}
 
 /** Date the current (next) survey ends at, or SimTime::never() if no more
  * surveys take place. */
 inline SimDate nextSurveyDate() {
-    return impl::nextSurveyDate;
+    return SimContext::current().monNextSurveyDate;
 }
 
 /// The number of cohort sets
@@ -41,7 +41,11 @@ SimDate readSurveyDates( const scnXml::Monitoring& monitoring );
 /// Call before start of simulation to set up outputs. Call readSurveyDates first.
 void initReporting( const scnXml::Scenario& scenario );
 
-/// Call after initialising interventions
+/// Undo initReporting() and any conditions, so that it may be called again
+/// (by tests). Reports already made by simulations must not be used after.
+void clearReporting();
+
+/// Call after initialising interventions (again if they are re-initialised)
 void initCohorts( const scnXml::Monitoring& monitoring );
 
 /// Call just before the start of the intervention period
@@ -50,7 +54,8 @@ void initMainSim();
 /// Call after all data for some survey number has been provided
 void concludeSurvey();
 
-/// Write survey data to output.txt (or configured file)
+/** Write survey data to output.txt (or configured file), as text or, with
+ * --output-format binary, in the binary format (see internal::writeBinary). */
 void writeSurveyData();
 
 // Checkpointing
@@ -62,6 +67,32 @@ namespace internal{
     // Write results to stream
     void write( std::ostream& stream );
     
+    /** Write results to stream in binary columnar format.
+     * 
+     * All values are little-endian. The file starts with a header:
+     * 
+     *  - magic: 8 characters "OMSURVEY"
+     *  - uint32 format version (1), number of surveys, number of blocks
+     * 
+     * followed by one header per block (output measure), in the order
+     * of output.txt:
+     * 
+     *  - int32 measure number (third column of output.txt)
+     *  - uint8 value type: 0 for int32, 1 for float64
+     *  - uint8 1 if there are values for each survey, 0 if there is only
+     *    one set of values (the infant mortality rate, reported as survey 1)
+     *  - 2 reserved bytes
+     *  - uint32 number of reported age groups, cohort sets, species,
+     *    genotypes and drugs (1 where not categorised)
+     *  - uint32 number of rows, n, followed by n int32 row identifiers
+     *    (second column of output.txt)
+     * 
+     * then the data of each block, in the same order: for each survey (or
+     * just once), n values.
+     * 
+     * util/binaryOutput.py reads this format and converts it to text. */
+    void writeBinary( std::ostream& stream );
+    
     /** Get the output cohort set numeric identifier given the internal one
      * (as returned by Survey::updateCohortSet()). */
     uint32_t cohortSetOutputId( uint32_t cohortSet );
@@ -56,11 +56,11 @@ namespace impl{
     // Constants or defined during init:
     size_t nSurveys = 0;        // number of reported surveys
     size_t nCohorts = 1;     // default: just the whole population
-    extern size_t surveyIndex;     // index in surveyDates of next survey
     vector<SurveyDate> surveyDates;     // dates of surveys
 }
 
 void updateConditions();        // defined in mon.cpp
+void prepareReports();          // defined in mon.cpp
 
 SimDate readSurveyDates( const scnXml::Monitoring& monitoring ){
     const scnXml::Surveys::SurveyTimeSequence& survs =
@@ -149,28 +149,30 @@ SimDate readSurveyDates( const scnXml::Monitoring& monitoring ){
 }
 
 void updateSurveyNumbers() {
-    if( impl::surveyIndex >= impl::surveyDates.size() ){
-        impl::survNumEvent = NOT_USED;
-        impl::survNumStat = NOT_USED;
-        impl::nextSurveyDate = SimDate::future();
+    SimContext& ctx = SimContext::current();
+    if( ctx.monSurveyIndex >= impl::surveyDates.size() ){
+        ctx.monSurvNumEvent = NOT_USED;
+        ctx.monSurvNumStat = NOT_USED;
+        ctx.monNextSurveyDate = SimDate::future();
     }else{
-        for( size_t i = impl::surveyIndex; i < impl::surveyDates.size(); ++i ){
-            impl::survNumEvent = impl::surveyDates[i].num;  // set to survey number or NOT_USED; this happens at least once!
-            if( impl::survNumEvent != NOT_USED ) break;        // stop at first reported survey
+        for( size_t i = ctx.monSurveyIndex; i < impl::surveyDates.size(); ++i ){
+            ctx.monSurvNumEvent = impl::surveyDates[i].num;  // set to survey number or NOT_USED; this happens at least once!
+            if( ctx.monSurvNumEvent != NOT_USED ) break;        // stop at first reported survey
         }
-        const SurveyDate& nextSurvey = impl::surveyDates[impl::surveyIndex];
-        impl::survNumStat = nextSurvey.num;     // may be NOT_USED; this is intended
-        impl::nextSurveyDate = nextSurvey.date;
+        const SurveyDate& nextSurvey = impl::surveyDates[ctx.monSurveyIndex];
+        ctx.monSurvNumStat = nextSurvey.num;     // may be NOT_USED; this is intended
+        ctx.monNextSurveyDate = nextSurvey.date;
     }
 }
 void initMainSim(){
-    impl::surveyIndex = 0;
-    impl::isInit = true;
+    prepareReports();
+    SimContext::current().monSurveyIndex = 0;
+    SimContext::current().monIsInit = true;
     updateSurveyNumbers();
 }
 void concludeSurvey(){
     updateConditions();
-    impl::surveyIndex += 1;
+    SimContext::current().monSurveyIndex += 1;
     updateSurveyNumbers();
 }
 
@@ -193,13 +195,17 @@ void writeSurveyData ()
     string filename = util::CommandLine::getOutputName();
     auto mode = std::ios::out | std::ios::binary;
     
+    const bool binary = util::CommandLine::option( util::CommandLine::BINARY_OUTPUT );
+    
     if (util::CommandLine::option( util::CommandLine::COMPRESS_OUTPUT )) {
         filename.append(".gz");
         ogzstream stream(filename.c_str(), mode);
-        writeToStream(stream);
+        if( binary ) internal::writeBinary(stream);
+        else writeToStream(stream);
     } else {
         ofstream stream(filename, mode);
-        writeToStream(stream);
+        if( binary ) internal::writeBinary(stream);
+        else writeToStream(stream);
     }
 }
 
@@ -246,6 +252,9 @@ bool notPowerOfTwo( uint32_t num ){
 // Init cohort sets. Depends on interventions (initialise those first).
 void initCohorts( const scnXml::Monitoring& monitoring )
 {
+    // may be called again after InterventionManager::initBranch
+    cohortSubPopIds.clear();
+    cohortSubPopNumbers.clear();
     if( monitoring.getCohorts().present() ){
         const scnXml::Cohorts monCohorts = monitoring.getCohorts().get();
         uint32_t nextId = 0;
@@ -28,10 +28,15 @@
 #include "Clinical/ClinicalModel.h"
 #include "Host/Human.h"
 #include "util/errors.h"
+#include "util/parallel.h"
+#include "SimContext.h"
 #include "schema/scenario.h"
 
 #include <typeinfo>
+#include <limits>
+#include <algorithm>
 #include <iostream>
+#include <cstring>
 #include <boost/format.hpp>
 
 namespace OM {
@@ -41,7 +46,7 @@ NamedMeasureMapT namedOutMeasures;
 set<Measure> validCondMeasures;
 
 struct Condition {
-    bool value; // whether the condition was satisfied during the last survey
+    bool initialState;  // value before the first survey
     bool isDouble;
     Measure measure;
     uint8_t method;
@@ -49,12 +54,7 @@ struct Condition {
 };
 
 namespace impl {
-    // Accumulators, variables:
-    bool isInit = false;
-    size_t surveyIndex = 0;     // index in surveyTimes of next survey
-    size_t survNumEvent = NOT_USED, survNumStat = NOT_USED;
-    SimDate nextSurveyDate = SimDate::future();
-    
+    // Definitions of conditions (values are in Reports):
     vector<Condition> conditions;
 }
 
@@ -110,17 +110,15 @@ struct MonIndex {
             (a % nAges))));
     }
     
-    // Write out some data from results.
-    // 
-    // @param stream Data sink
-    // @param surveyNum Number to write in output (should start from 1 unlike in code)
-    // @param results Vector of results
-    // @param surveyStart Index in results where data for the current survey starts
-    template<typename T>
-    void write( ostream& stream, int surveyNum, const OutMeasure& om,
-            const vector<T>& results, size_t surveyStart ) const
+    // Get the layout of output rows for one survey, in output order: the
+    // second output column (encoding age group, cohort set, species,
+    // genotype and drug) and the corresponding index relative to the start
+    // of the survey in the result array.
+    void layout( const OutMeasure& om, vector<int32_t>& col2,
+            vector<size_t>& indices ) const
     {
-        assert(results.size() >= surveyStart + size());
+        col2.clear();
+        indices.clear();
         // First age group starts at 1, unless there isn't an age group:
         const int ageGroupAdd = om.byAge ? 1 : 0;
         // Number of *reported* age categories: either no categorisation (1) or there is an extra unreported category
@@ -129,11 +127,9 @@ struct MonIndex {
             assert( nAges == 1 && nCohorts == 1 && nDrugs == 1 );
             for( size_t species = 0; species < nSpecies; ++species ){
             for( size_t genotype = 0; genotype < nGenotypes; ++genotype ){
-                const int col2 = species + 1 +
-                    1000000 * genotype;
-                T value = results[surveyStart + index(0, 0, species, genotype, 0)];
-                stream << surveyNum << '\t' << col2 << '\t' << om.outId
-                    << '\t' << value << lineEnd;
+                col2.push_back( species + 1 +
+                    1000000 * genotype );
+                indices.push_back( index(0, 0, species, genotype, 0) );
             } }
         }else if( om.byDrug ){
             assert( nSpecies == 1 && nGenotypes == 1 );
@@ -142,12 +138,10 @@ struct MonIndex {
             for( size_t ageGroup = 0; ageGroup < nAgeCats; ++ageGroup ){
             for( size_t drug = 0; drug < nDrugs; ++drug ){
                 // Yeah, >999 age groups clashes with cohort sets, but unlikely a real issue
-                const int col2 = ageGroup + ageGroupAdd +
+                col2.push_back( ageGroup + ageGroupAdd +
                     1000 * internal::cohortSetOutputId( cohortSet ) +
-                    1000000 * (drug + 1);
-                T value = results[surveyStart + index(ageGroup, cohortSet, 0, 0, drug)];
-                stream << surveyNum << '\t' << col2 << '\t' << om.outId
-                    << '\t' << value << lineEnd;
+                    1000000 * (drug + 1) );
+                indices.push_back( index(ageGroup, cohortSet, 0, 0, drug) );
             } } }
         }else{
             assert( nSpecies == 1 && nDrugs == 1 );
@@ -156,17 +150,82 @@ struct MonIndex {
             for( size_t ageGroup = 0; ageGroup < nAgeCats; ++ageGroup ){
             for( size_t genotype = 0; genotype < nGenotypes; ++genotype ){
                 // Yeah, >999 age groups clashes with cohort sets, but unlikely a real issue
-                const int col2 = ageGroup + ageGroupAdd +
+                col2.push_back( ageGroup + ageGroupAdd +
                     1000 * internal::cohortSetOutputId( cohortSet ) +
-                    1000000 * genotype;
-                T value = results[surveyStart + index(ageGroup, cohortSet, 0, genotype, 0)];
-                stream << surveyNum << '\t' << col2 << '\t' << om.outId
-                    << '\t' << value << lineEnd;
+                    1000000 * genotype );
+                indices.push_back( index(ageGroup, cohortSet, 0, genotype, 0) );
             } } }
         }
     }
+    
+    // Write out some data from results.
+    // 
+    // @param stream Data sink
+    // @param surveyNum Number to write in output (should start from 1 unlike in code)
+    // @param results Vector of results
+    // @param surveyStart Index in results where data for the current survey starts
+    template<typename T>
+    void write( ostream& stream, int surveyNum, const OutMeasure& om,
+            const vector<T>& results, size_t surveyStart ) const
+    {
+        assert(results.size() >= surveyStart + size());
+        vector<int32_t> col2;
+        vector<size_t> indices;
+        layout( om, col2, indices );
+        for( size_t row = 0; row < col2.size(); ++row ){
+            T value = results[surveyStart + indices[row]];
+            stream << surveyNum << '\t' << col2[row] << '\t' << om.outId
+                << '\t' << value << lineEnd;
+        }
+    }
 };
 
+// Binary output (see internal::writeBinary). Values are written
+// little-endian regardless of platform.
+namespace binary {
+    void put( ostream& stream, uint8_t x ){
+        stream.put( static_cast<char>(x) );
+    }
+    void put( ostream& stream, uint32_t x ){
+        char buf[4];
+        for( int i = 0; i < 4; ++i ) buf[i] = static_cast<char>( (x >> (8 * i)) & 0xFF );
+        stream.write( buf, 4 );
+    }
+    void put( ostream& stream, int32_t x ){
+        put( stream, static_cast<uint32_t>(x) );
+    }
+    void put( ostream& stream, double x ){
+        static_assert( sizeof(double) == 8, "expected 64-bit double" );
+        uint64_t u;
+        memcpy( &u, &x, 8 );
+        char buf[8];
+        for( int i = 0; i < 8; ++i ) buf[i] = static_cast<char>( (u >> (8 * i)) & 0xFF );
+        stream.write( buf, 8 );
+    }
+    
+    const char MAGIC[8] = { 'O', 'M', 'S', 'U', 'R', 'V', 'E', 'Y' };
+    const uint32_t VERSION = 1;
+    enum ValueType { INT32 = 0, FLOAT64 = 1 };
+    
+    // Write a block header. A block is one output measure.
+    // perSurvey is 1 if the block has data for each survey, 0 if it has a
+    // single set of rows (written as survey 1 in text output after all
+    // surveys).
+    void putBlockHeader( ostream& stream, int outId, ValueType type,
+            uint8_t perSurvey, const uint32_t dims[5],
+            const vector<int32_t>& col2 )
+    {
+        put( stream, static_cast<int32_t>(outId) );
+        put( stream, static_cast<uint8_t>(type) );
+        put( stream, perSurvey );
+        put( stream, static_cast<uint8_t>(0) );  // reserved
+        put( stream, static_cast<uint8_t>(0) );
+        for( size_t i = 0; i < 5; ++i ) put( stream, dims[i] );
+        put( stream, static_cast<uint32_t>(col2.size()) );
+        foreach( int32_t c, col2 ) put( stream, c );
+    }
+}
+
 struct MonIndByMeasure{
     bool operator() (const MonIndex& i,const MonIndex& j) {
         if( i.measure != j.measure ) return i.measure < j.measure;
@@ -174,11 +233,68 @@ struct MonIndByMeasure{
     }
 } monIndByMeasure;
 
+// Reported values of type T of one simulation; the layout is described by
+// a Store.
+template<typename T>
+struct StoreData{
+    // These are the stored reports (multidimensional; size is Store::size()
+    // and indices are `survey * surveySize + measures[m].index(...)` for
+    // some `m` of the Store).
+    vector<T> reports;
+    
+    // Partial sums reported by one worker thread since the last reduce().
+    // `reports` has the same layout as StoreData::reports (allocated on
+    // first use); only surveys in [first, last) have been written.
+    struct Shard {
+        Shard() : first(numeric_limits<size_t>::max()), last(0) {}
+        vector<T> reports;
+        size_t first, last;
+    };
+    // One shard per thread (indexed by util::parallel::chunkIndex()); only
+    // used when the store's accumulator is null.
+    vector<Shard> shards;
+};
+
+/** Everything reported by one simulation (held by its SimContext): values
+ * of each store and the state of conditions. */
+class Reports{
+public:
+    StoreData<int> storeI;
+    StoreData<double> storeF;
+    // Value of each of impl::conditions: whether it was satisfied during the
+    // last survey
+    vector<bool> conditions;
+};
+
+void ReportsDeleter::operator()( Reports *reports ) const{
+    delete reports;
+}
+
+// Reports of the simulation bound to the calling thread. These must have been
+// allocated by prepareReports() (done by initMainSim, checkpointing and
+// output); this is not done here since reports may come from worker threads.
+inline Reports& reports(){
+    assert( SimContext::current().monReports );
+    return *SimContext::current().monReports;
+}
+
 // Store data of type T which is to be reported
+// 
+// The store describes the layout of reports, which is shared by all
+// simulations; the values are in each simulation's Reports.
 template<typename T>
 class Store{
 public:
-    Store() : surveySize(0) {}
+    /// @param accumulator Function calling add() on this store, or null.
+    /// @param member The data of this store in Reports
+    /// 
+    /// When updating humans on several threads (see util/parallel.h),
+    /// reports from worker threads are either deferred through the
+    /// accumulator (preserving the order of floating-point sums) or, if this
+    /// is null, added to a per-worker shard which is merged by reduce().
+    Store( util::parallel::AccumulateFn accumulator,
+            StoreData<T> Reports::*member ) :
+        surveySize(0), accumulator(accumulator), member(member) {}
     
 private:
     // This lists all enabled outputs, sorted by `measure` (first field, of
@@ -193,14 +309,59 @@ private:
     
     // Number of indices in `reports` used by a single survey
     size_t surveySize;
-    // These are the stored reports (multidimensional; size is `size()` and
-    // indices are `survey * surveySize + measures[m].index(...)` for some `m`).
-    vector<T> reports;
+    
+    // Calls add() on this store; see constructor
+    util::parallel::AccumulateFn accumulator;
+    
+    // Where data of this store is in Reports
+    StoreData<T> Reports::*member;
+    
+    typedef typename StoreData<T>::Shard Shard;
     
     // get size of reports
     inline size_t size(){ return surveySize * impl::nSurveys; }
     
+    // Data of the simulation bound to the calling thread
+    inline StoreData<T>& data(){ return reports().*member; }
+    
+    // Add val to reports[index] (for the given survey), or to the calling
+    // worker's shard / log if humans are being updated on several threads.
+    inline void store( size_t survey, size_t index, T val ){
+        StoreData<T>& d = data();
+        assert( index < d.reports.size() );
+        if( util::parallel::deferring() ){
+            if( accumulator != 0 ){
+                util::parallel::defer( accumulator, index, val );
+                return;
+            }
+            assert( util::parallel::chunkIndex() < d.shards.size() );
+            Shard& shard = d.shards[util::parallel::chunkIndex()];
+            if( shard.reports.empty() ) shard.reports.assign( d.reports.size(), 0 );
+            shard.reports[index] += val;
+            shard.first = std::min( shard.first, survey );
+            shard.last = std::max( shard.last, survey + 1 );
+        }else{
+            d.reports[index] += val;
+        }
+    }
+    
 public:
+    // Add a value to reports; only for use by the accumulator
+    inline void add( size_t index, T val ){
+        data().reports[index] += val;
+    }
+    
+    // Size the data of this store in r, if not already done. Reports must
+    // not have been made since the layout last changed.
+    void prepare( Reports& r ){
+        StoreData<T>& d = r.*member;
+        if( d.reports.size() != size() ){
+            d.reports.assign( size(), 0 );
+            // The number of threads must not be increased after this point.
+            d.shards.assign( util::parallel::numThreads(), Shard() );
+        }
+    }
+    
     // Set up ready to accept reports. The passed list includes all measures
     // used; we ignore those of the wrong type.
     void init( const vector<OutMeasure>& enabledMeasures, size_t nSp, size_t nD ){
@@ -224,17 +385,21 @@ public:
         }
         
         sortEnabledMeasures();
-        
-        // Leave a few spare slots for potential conditions using variables not already reported:
-        reports.reserve(size() + 12);
-        reports.assign(size(), 0);
+        // Data is sized by prepare()
+    }
+    
+    // Undo init() and enableCondition()
+    void clear(){
+        measures.clear();
+        measure_map.clear();
+        surveySize = 0;
     }
     
     // Enable reporting by an additional measure, which does not categorise.
     // (Called after init(); does nothing if this measure is already enabled.)
     // 
     // This *must* be called before any reporting takes place, since it adjusts
-    // offsets in `reports`.
+    // offsets in `reports` (sized by the next prepare()).
     void enableCondition( const OutMeasure& om ){
         assert( om.isDouble ? typeid(T) == typeid(double) : typeid(T) == typeid(int) );
         assert( om.m < M_NUM );
@@ -263,7 +428,6 @@ public:
         measures.push_back(m);
         
         sortEnabledMeasures();
-        reports.resize(size(), 0);
     }
     
     // Sort measures, then fix the offsets and surveySize, then set measure_map
@@ -301,8 +465,7 @@ public:
             
             size_t index = survey * surveySize +
                     ind.index(ageIndex, cohortSet, species, genotype, drug);
-            assert( index < reports.size() );
-            reports[index] += val;
+            store( survey, index, val );
         }
     }
     
@@ -327,8 +490,24 @@ public:
             
             size_t index = survey * surveySize +
                     ind.index(ageIndex, cohortSet, 0, 0, 0);
-            assert( index < reports.size() );
-            reports[index] += val;
+            store( survey, index, val );
+        }
+    }
+    
+    // Add all shards into reports, in a fixed order, and clear them.
+    void reduce(){
+        StoreData<T>& d = data();
+        foreach( Shard& shard, d.shards ){
+            if( shard.first < shard.last ){
+                assert( shard.reports.size() == d.reports.size() );
+                const size_t end = shard.last * surveySize;
+                for( size_t i = shard.first * surveySize; i < end; ++i ){
+                    d.reports[i] += shard.reports[i];
+                    shard.reports[i] = 0;
+                }
+            }
+            shard.first = numeric_limits<size_t>::max();
+            shard.last = 0;
         }
     }
     
@@ -348,6 +527,7 @@ public:
             assert(ind.measure == measure);
             if( ind.deployMask != method ) continue;    // incompatible deployment mode: skip
             
+            const vector<T>& reports = data().reports;
             const size_t off = survey * surveySize + ind.offset;
             T sum = 0;
             size_t end2 = off + ind.size();
@@ -367,23 +547,61 @@ public:
         return measure_map[measure].second > measure_map[measure].first;
     }
     
-    // Write stored values to stream for some output measure, om
-    void write( ostream& stream, size_t survey, const OutMeasure& om ){
+    // Find the index used to record output measure om
+    const MonIndex& outIndex( const OutMeasure& om ) const{
         assert(om.m < measure_map.size());
         for( size_t i = measure_map[om.m].first, end = measure_map[om.m].second;
             i < end; ++i )
         {
             assert(i < measures.size());
             if( measures[i].outMeasure == om.outId ){
-                measures[i].write( stream, survey + 1, om, reports, survey * surveySize );
-                return;
+                return measures[i];
             }
         }
         assert(false && "measure not found in records");
+        throw SWITCH_DEFAULT_EXCEPTION;
+    }
+    
+    // Write stored values to stream for some output measure, om
+    void write( ostream& stream, size_t survey, const OutMeasure& om ){
+        outIndex( om ).write( stream, survey + 1, om, data().reports, survey * surveySize );
+    }
+    
+    // Binary output: write the block header for output measure om
+    void writeBinaryHeader( ostream& stream, const OutMeasure& om ){
+        const MonIndex& ind = outIndex( om );
+        vector<int32_t> col2;
+        vector<size_t> indices;
+        ind.layout( om, col2, indices );
+        const uint32_t dims[5] = {
+            static_cast<uint32_t>( ind.nAges == 1 ? 1 : ind.nAges - 1 ),
+            static_cast<uint32_t>( ind.nCohorts ),
+            static_cast<uint32_t>( ind.nSpecies ),
+            static_cast<uint32_t>( ind.nGenotypes ),
+            static_cast<uint32_t>( ind.nDrugs ) };
+        binary::putBlockHeader( stream, om.outId,
+                typeid(T) == typeid(double) ? binary::FLOAT64 : binary::INT32,
+                1, dims, col2 );
+    }
+    // Binary output: write values of output measure om for all surveys
+    void writeBinaryData( ostream& stream, const OutMeasure& om ){
+        const MonIndex& ind = outIndex( om );
+        vector<int32_t> col2;
+        vector<size_t> indices;
+        ind.layout( om, col2, indices );
+        const vector<T>& reports = data().reports;
+        for( size_t survey = 0; survey < impl::nSurveys; ++survey ){
+            const size_t surveyStart = survey * surveySize;
+            foreach( size_t i, indices ){
+                binary::put( stream, reports[surveyStart + i] );
+            }
+        }
     }
     
     // Checkpointing
     void checkpoint( ostream& stream ){
+        reduce();
+        vector<T>& reports = data().reports;
         reports.size() & stream;
         foreach (T& y, reports) {
             y & stream;
@@ -396,6 +614,7 @@ public:
         if( l != size() ){
             throw util::checkpoint_error( "mon::reports: invalid list size" );
         }
+        vector<T>& reports = data().reports;
         reports.resize (l);
         foreach (T& y, reports) {
             y & stream;
@@ -406,9 +625,30 @@ public:
 
 // Enabled measures:
 vector<OutMeasure> reportedMeasures;
-// Stores of reported data by two different types:
-Store<int> storeI;
-Store<double> storeF;
+// Stores of reported data by two different types. Integer sums don't depend
+// on order, so these use per-thread shards; floating-point reports from
+// worker threads are applied in serial order via accumulateF.
+void accumulateF( size_t index, double val );
+Store<int> storeI( 0, &Reports::storeI );
+Store<double> storeF( &accumulateF, &Reports::storeF );
+void accumulateF( size_t index, double val ){
+    storeF.add( index, val );
+}
+
+// Allocate and size the reports of the simulation bound to the calling
+// thread, if not already done (called by initMainSim).
+void prepareReports(){
+    unique_ptr<Reports, ReportsDeleter>& r = SimContext::current().monReports;
+    if( !r ) r.reset( new Reports() );
+    storeI.prepare( *r );
+    storeF.prepare( *r );
+    if( r->conditions.size() != impl::conditions.size() ){
+        r->conditions.clear();
+        foreach( const Condition& cond, impl::conditions ){
+            r->conditions.push_back( cond.initialState );
+        }
+    }
+}
 int reportIMR = -1; // special output for fitting
 
 struct MeasureByOutId{
@@ -528,6 +768,14 @@ void initReporting( const scnXml::Scenario& scenario ){
     storeF.init( reportedMeasures, nSpecies, nDrugs );
 }
 
+void clearReporting(){
+    reportedMeasures.clear();
+    reportIMR = -1;
+    storeI.clear();
+    storeF.clear();
+    impl::conditions.clear();
+}
+
 size_t setupCondition( const string& measureName, double minValue,
                        double maxValue, bool initialState )
 {
@@ -547,7 +795,7 @@ size_t setupCondition( const string& measureName, double minValue,
     else storeI.enableCondition(om);
     
     Condition condition;
-    condition.value = initialState;
+    condition.initialState = initialState;
     condition.isDouble = om.isDouble;
     condition.measure = om.m;
     condition.method = om.method;
@@ -558,19 +806,30 @@ size_t setupCondition( const string& measureName, double minValue,
 }
 
 void updateConditions() {
-    foreach( Condition& cond, impl::conditions ){
+    prepareReports();
+    // merge results from worker threads (concludeSurvey calls this first)
+    storeI.reduce();
+    storeF.reduce();
+    const size_t survey = SimContext::current().monSurvNumStat;
+    vector<bool>& values = reports().conditions;
+    for( size_t i = 0; i < impl::conditions.size(); ++i ){
+        const Condition& cond = impl::conditions[i];
         double val = cond.isDouble ?
-            storeF.get_sum( cond.measure, cond.method, impl::survNumStat ) :
-            storeI.get_sum( cond.measure, cond.method, impl::survNumStat );
-        cond.value = (val >= cond.min && val <= cond.max);
+            storeF.get_sum( cond.measure, cond.method, survey ) :
+            storeI.get_sum( cond.measure, cond.method, survey );
+        values[i] = (val >= cond.min && val <= cond.max);
     }
 }
 bool checkCondition( size_t conditionKey ){
     assert( conditionKey < impl::conditions.size() );
-    return impl::conditions[conditionKey].value;
+    prepareReports();
+    return reports().conditions[conditionKey];
 }
 
 void internal::write( ostream& stream ){
+    prepareReports();
+    storeI.reduce();
+    storeF.reduce();
     for( size_t survey = 0; survey < impl::nSurveys; ++survey ){
         foreach( const OutMeasure& om, reportedMeasures ){
             if( om.m >= M_NUM ){
@@ -593,18 +852,63 @@ void internal::write( ostream& stream ){
     }
 }
 
+void internal::writeBinary( ostream& stream ){
+    prepareReports();
+    storeI.reduce();
+    storeF.reduce();
+    
+    size_t nBlocks = reportIMR >= 0 ? 1 : 0;
+    foreach( const OutMeasure& om, reportedMeasures ){
+        if( om.m < M_NUM ) nBlocks += 1;
+    }
+    stream.write( binary::MAGIC, sizeof(binary::MAGIC) );
+    binary::put( stream, binary::VERSION );
+    binary::put( stream, static_cast<uint32_t>(impl::nSurveys) );
+    binary::put( stream, static_cast<uint32_t>(nBlocks) );
+    
+    foreach( const OutMeasure& om, reportedMeasures ){
+        if( om.m >= M_NUM ){
+            assert( om.m == M_ALL_CAUSE_IMR && reportIMR >= 0 );
+            continue;
+        } else if( om.isDouble ) {
+            storeF.writeBinaryHeader( stream, om );
+        } else {
+            storeI.writeBinaryHeader( stream, om );
+        }
+    }
+    const uint32_t scalarDims[5] = { 1, 1, 1, 1, 1 };
+    if( reportIMR >= 0 ){
+        // Infant mortality rate: a single value (see write())
+        binary::putBlockHeader( stream, reportIMR, binary::FLOAT64, 0,
+                scalarDims, vector<int32_t>( 1, 1 ) );
+    }
+    
+    foreach( const OutMeasure& om, reportedMeasures ){
+        if( om.m >= M_NUM ){
+            continue;
+        } else if( om.isDouble ) {
+            storeF.writeBinaryData( stream, om );
+        } else {
+            storeI.writeBinaryData( stream, om );
+        }
+    }
+    if( reportIMR >= 0 ){
+        binary::put( stream, Clinical::InfantMortality::allCause() );
+    }
+}
+
 // Report functions: each reports to all usable stores (i.e. correct data type
 // and where parameters don't have to be fabricated).
 // void reportMI( Measure measure, int val ){
 //     storeI.report( val, measure, impl::currentSurvey, 0, 0, 0, 0, 0 );
 // }
 void reportEventMHI( Measure measure, const Host::Human& human, int val ){
-    const size_t survey = impl::survNumEvent;
+    const size_t survey = SimContext::current().monSurvNumEvent;
     const size_t ageIndex = human.monAgeGroup().i();
     storeI.report( val, measure, survey, ageIndex, human.cohortSet(), 0, 0, 0 );
 }
 void reportStatMHI( Measure measure, const Host::Human& human, int val ){
-    const size_t survey = impl::survNumStat;
+    const size_t survey = SimContext::current().monSurvNumStat;
     const size_t ageIndex = human.monAgeGroup().i();
     storeI.report( val, measure, survey, ageIndex, human.cohortSet(), 0, 0, 0 );
 }
@@ -616,14 +920,14 @@ void reportMSACI( Measure measure, size_t survey,
 void reportStatMHGI( Measure measure, const Host::Human& human, size_t genotype,
                  int val )
 {
-    const size_t survey = impl::survNumStat;
+    const size_t survey = SimContext::current().monSurvNumStat;
     const size_t ageIndex = human.monAgeGroup().i();
     storeI.report( val, measure, survey, ageIndex, human.cohortSet(), 0, genotype, 0 );
 }
 void reportStatMHPI( Measure measure, const Host::Human& human, size_t drugIndex,
                 int val )
 {
-    const size_t survey = impl::survNumStat;
+    const size_t survey = SimContext::current().monSurvNumStat;
     const size_t ageIndex = human.monAgeGroup().i();
     storeI.report( val, measure, survey, ageIndex, human.cohortSet(), 0, 0, drugIndex );
 }
@@ -633,7 +937,7 @@ void reportEventMHD( Measure measure, const Host::Human& human,
                 Deploy::Method method )
 {
     const int val = 1;  // always report 1 deployment
-    const size_t survey = impl::survNumEvent;
+    const size_t survey = SimContext::current().monSurvNumEvent;
     size_t ageIndex = human.monAgeGroup().i();
     storeI.deploy( val, measure, survey, ageIndex, human.cohortSet(), method );
     // This is for nTreatDeployments:
@@ -642,27 +946,27 @@ void reportEventMHD( Measure measure, const Host::Human& human,
 }
 
 void reportStatMF( Measure measure, double val ){
-    storeF.report( val, measure, impl::survNumStat, 0, 0, 0, 0, 0 );
+    storeF.report( val, measure, SimContext::current().monSurvNumStat, 0, 0, 0, 0, 0 );
 }
 void reportStatMHF( Measure measure, const Host::Human& human, double val ){
-    const size_t survey = impl::survNumStat;
+    const size_t survey = SimContext::current().monSurvNumStat;
     const size_t ageIndex = human.monAgeGroup().i();
     storeF.report( val, measure, survey, ageIndex, human.cohortSet(), 0, 0, 0 );
 }
 void reportStatMACGF( Measure measure, size_t ageIndex, uint32_t cohortSet,
                   size_t genotype, double val )
 {
-    const size_t survey = impl::survNumStat;
+    const size_t survey = SimContext::current().monSurvNumStat;
     storeF.report( val, measure, survey, ageIndex, cohortSet, 0, genotype, 0 );
 }
 void reportStatMACSGF( Measure measure, size_t ageIndex, uint32_t cohortSet,
                   size_t species, size_t genotype, double val )
 {
-    const size_t survey = impl::survNumStat;
+    const size_t survey = SimContext::current().monSurvNumStat;
     storeF.report( val, measure, survey, ageIndex, cohortSet, species, genotype, 0 );
 }
 void reportStatMHPF( Measure measure, const Host::Human& human, size_t drug, double val ){
-    const size_t survey = impl::survNumStat;
+    const size_t survey = SimContext::current().monSurvNumStat;
     const size_t ageIndex = human.monAgeGroup().i();
     storeF.report( val, measure, survey, ageIndex, human.cohortSet(), 0, 0, drug );
 }
@@ -673,11 +977,11 @@ void reportStatMHGF( Measure measure, const Host::Human& human, size_t genotype,
                  genotype, val );
 }
 void reportStatMSF( Measure measure, size_t species, double val ){
-    const size_t survey = impl::survNumStat;
+    const size_t survey = SimContext::current().monSurvNumStat;
     storeF.report( val, measure, survey, 0, 0, species, 0, 0 );
 }
 void reportStatMSGF( Measure measure, size_t species, size_t genotype, double val ){
-    const size_t survey = impl::survNumStat;
+    const size_t survey = SimContext::current().monSurvNumStat;
     storeF.report( val, measure, survey, 0, 0, species, genotype, 0 );
 }
 
@@ -686,22 +990,26 @@ bool isUsedM( Measure measure ){
 }
 
 void checkpoint( ostream& stream ){
-    impl::isInit & stream;
-    impl::surveyIndex & stream;
-    impl::survNumEvent & stream;
-    impl::survNumStat & stream;
-    impl::nextSurveyDate & stream;
+    SimContext& ctx = SimContext::current();
+    ctx.monIsInit & stream;
+    ctx.monSurveyIndex & stream;
+    ctx.monSurvNumEvent & stream;
+    ctx.monSurvNumStat & stream;
+    ctx.monNextSurveyDate & stream;
     
+    prepareReports();
     storeI.checkpoint(stream);
     storeF.checkpoint(stream);
 }
 void checkpoint( istream& stream ){
-    impl::isInit & stream;
-    impl::surveyIndex & stream;
-    impl::survNumEvent & stream;
-    impl::survNumStat & stream;
-    impl::nextSurveyDate & stream;
+    SimContext& ctx = SimContext::current();
+    ctx.monIsInit & stream;
+    ctx.monSurveyIndex & stream;
+    ctx.monSurvNumEvent & stream;
+    ctx.monSurvNumStat & stream;
+    ctx.monNextSurveyDate & stream;
     
+    prepareReports();
     storeI.checkpoint(stream);
     storeF.checkpoint(stream);
 }
@@ -47,12 +47,26 @@ int main(int argc, char* argv[]) {
         
         // Set up the simulator
         Simulator simulator( documentLoader.document() );
+        if( util::CommandLine::getWarmupCacheDir() != "" ||
+            !util::CommandLine::getBranches().empty() )
+        {
+            uint64_t hash = documentLoader.warmupHash();
+            if( util::CommandLine::getWarmupCacheDir() != "" )
+                simulator.useWarmupCache( hash );
+            if( !util::CommandLine::getBranches().empty() )
+                simulator.useBranches( hash );
+        }
         
         // Save changes to the document if any occurred.
         documentLoader.saveDocument();
         
-        if ( !util::CommandLine::option(util::CommandLine::SKIP_SIMULATION) )
+        if ( util::CommandLine::option(util::CommandLine::SKIP_SIMULATION) ){
+            // nothing to run
+        } else if ( !util::CommandLine::getSeeds().empty() ) {
+            simulator.runEnsemble(documentLoader.document().getMonitoring());
+        } else {
             simulator.start(documentLoader.document().getMonitoring());
+        }
         
         // simulation's destructor runs
     } catch (const OM::util::cmd_exception& e) {
@@ -315,7 +315,37 @@ inline SimTime mod_nn( const SimTime lhs, const SimTime rhs ){
     return SimTime(util::mod_nn(lhs.d, rhs.d));
 }
 
-/** Encapsulates static variables: sim time. */
+/** Simulation time variables of one simulation (part of SimContext). */
+struct SimClock {
+    SimClock();
+    
+    SimTime t0;         // time at start of update (equal to t1 between updates)
+    SimTime t1;         // time at end of update
+    SimTime interv;     // time relative to start of intervention period
+#ifndef NDEBUG
+    bool in_update;     // only true during human/population/transmission update
+#endif
+    
+    /// Start an update of one time step (at t1)
+    inline void startStep(){
+        t1 += SimTime::oneTS();
+#ifndef NDEBUG
+        in_update = true;
+#endif
+    }
+    /// End the update started by startStep()
+    inline void endStep(){
+#ifndef NDEBUG
+        in_update = false;
+#endif
+        t0 = t1;
+        interv += SimTime::oneTS();
+    }
+};
+
+/** Encapsulates static variables: sim time.
+ * 
+ * Time variables are those of the SimContext bound to the calling thread. */
 class sim {
 public:
     ///@brief Simulation constants
@@ -346,16 +376,16 @@ public:
      * This is what is mostly used during an update. It is never negative and
      * increases throughout the simulation. */
     static inline SimTime ts0(){
-        assert(in_update);      // should only be used during updates
-        return s_t0;
+        assert(s_clock->in_update);     // should only be used during updates
+        return s_clock->t0;
     }
     /** Time at the end of a time step update.
      * 
      * During an update, ts0() + oneTS() = ts1(). Neither this nor ts0 should
      * be used outside of updates. */
     static inline SimTime ts1(){
-        assert(in_update);      // should only be used during updates
-        return s_t1;
+        assert(s_clock->in_update);     // should only be used during updates
+        return s_clock->t1;
     }
     /**
      * Time steps are mid-day to mid-day, and this is the time at mid-day (i.e.
@@ -365,15 +395,15 @@ public:
      * updates. Cannot be used during human or vector update.
      */
     static inline SimTime now(){
-        assert(!in_update);     // only for use outside of step updates
-        return s_t0;   // which is equal to s_t1 outside of updates, but that's a detail
+        assert(!s_clock->in_update);    // only for use outside of step updates
+        return s_clock->t0;    // which is equal to s_t1 outside of updates, but that's a detail
     }
     /** During updates, this is ts0; between, this is now. */
-    static inline SimTime nowOrTs0(){ return s_t0; }
+    static inline SimTime nowOrTs0(){ return s_clock->t0; }
     /** During updates, this is ts1; between, this is now. */
-    static inline SimTime nowOrTs1(){ return s_t1; }
+    static inline SimTime nowOrTs1(){ return s_clock->t1; }
     /** During updates, this is ts0; between, it is now - 1. */
-    static inline SimTime latestTs0(){ return s_t1 - SimTime::oneTS(); }
+    static inline SimTime latestTs0(){ return s_clock->t1 - SimTime::oneTS(); }
     //@}
     
     ///@brief Access intervention-time variables
@@ -383,7 +413,7 @@ public:
     /// This equals (intervDate() - startDate()), but happens to be the most
     /// common way that intervention-period dates are used.
     static inline SimTime intervTime() {
-        return s_interv;
+        return s_clock->interv;
     }
     
     /// The current date.
@@ -393,7 +423,7 @@ public:
     /// returns a large negative value.)
     /// 
     /// Intervention deployment times are relative to this date.
-    static inline SimDate intervDate(){ return s_start + s_interv; }
+    static inline SimDate intervDate(){ return s_start + s_clock->interv; }
     //@}
     
 private:
@@ -401,20 +431,9 @@ private:
     static void init( const scnXml::Scenario& scenario );
     
     // Start of update: called by Simulator
-    static inline void start_update(){
-        s_t1 += SimTime::oneTS();
-#ifndef NDEBUG
-        in_update = true;
-#endif
-    }
+    static inline void start_update(){ s_clock->startStep(); }
     // End of update: called by Simulator
-    static inline void end_update(){
-#ifndef NDEBUG
-        in_update = false;
-#endif
-        s_t0 = s_t1;
-        s_interv += SimTime::oneTS();
-    }
+    static inline void end_update(){ s_clock->endStep(); }
     
     // Scenario constants
     static SimDate s_start;
@@ -422,16 +441,11 @@ private:
     
     static SimTime s_max_human_age;
     
-    // Global variables
-#ifndef NDEBUG
-    static bool in_update;       // only true during human/population/transmission update
-#endif
-    static SimTime s_t0;
-    static SimTime s_t1;
-    
-    static SimTime s_interv;
+    // Clock of the bound SimContext
+    static thread_local SimClock *s_clock;
     
     friend class Simulator;
+    friend class SimContext;
     friend class ::UnittestUtil;
 };
 
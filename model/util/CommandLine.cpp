@@ -23,6 +23,7 @@
 #include "util/errors.h"
 #include "util/StreamValidator.h"
 #include "util/DocumentLoader.h"
+#include "util/parallel.h"
 /* if you get compile errors like "version.h not found", run CMake first */
 #include "util/version.h"
 
@@ -38,6 +39,41 @@ namespace OM { namespace util {
     string CommandLine::resourcePath;
     string CommandLine::outputName;
     string CommandLine::ctsoutName;
+    string CommandLine::warmupCacheDir;
+    vector<string> CommandLine::branches;
+    vector<uint64_t> CommandLine::seeds;
+    size_t CommandLine::numJobs = 1;
+    size_t CommandLine::checkpointSteps = 0;
+    double CommandLine::checkpointMinutes = 0.0;
+    size_t CommandLine::numThreads = 1;
+    size_t CommandLine::vectorWarmupSample = 0;
+    
+    /// Parse a list like "1-100,200" to seeds
+    void parseSeeds (const string& arg, vector<uint64_t>& seeds) {
+        size_t pos = 0;
+        while( pos <= arg.size() ){
+            size_t end = arg.find( ',', pos );
+            if( end == string::npos ) end = arg.size();
+            string range = arg.substr( pos, end - pos );
+            size_t dash = range.find( '-' );
+            try{
+                if( range.empty() || range[0] == '-' ) throw boost::bad_lexical_cast();
+                uint64_t first = lexical_cast<uint64_t>( range.substr( 0, dash ) );
+                uint64_t last = first;
+                if( dash != string::npos )
+                    last = lexical_cast<uint64_t>( range.substr( dash + 1 ) );
+                if( last < first )
+                    throw cmd_exception ("--seeds: bad range " + range);
+                for( uint64_t seed = first; seed <= last; ++seed ){
+                    seeds.push_back( seed );
+                    if( seed == last ) break;   // avoid overflow
+                }
+            }catch( boost::bad_lexical_cast& ){
+                throw cmd_exception ("--seeds: expected a list of seeds or ranges like 1-100,200");
+            }
+            pos = end + 1;
+        }
+    }
     
     string parseNextArg (int argc, char* argv[], int& i) {
 	++i;
@@ -48,6 +84,7 @@ namespace OM { namespace util {
     
     string CommandLine::parse (int argc, char* argv[]) {
 	bool cloHelp = false, cloVersion = false, cloError = false;
+	bool cloName = false;
 	string scenarioFile = "";
         outputName = "";
         ctsoutName = "";
@@ -85,14 +122,53 @@ namespace OM { namespace util {
                         throw cmd_exception ("--ctsout argument may only be given once");
                     }
                     ctsoutName = parseNextArg (argc, argv, i);
+                } else if (clo == "threads") {
+                    string arg = parseNextArg (argc, argv, i);
+                    try{
+                        int n = lexical_cast<int>(arg);
+                        if( n < 1 ) throw cmd_exception ("--threads: expected a positive number");
+                        numThreads = n;
+                    }catch( boost::bad_lexical_cast& ){
+                        throw cmd_exception ("--threads: expected a positive number");
+                    }
+                } else if (clo == "seeds") {
+                    parseSeeds( parseNextArg (argc, argv, i), seeds );
+                } else if (clo == "jobs") {
+                    string arg = parseNextArg (argc, argv, i);
+                    try{
+                        int n = lexical_cast<int>(arg);
+                        if( n < 1 ) throw cmd_exception ("--jobs: expected a positive number");
+                        numJobs = n;
+                    }catch( boost::bad_lexical_cast& ){
+                        throw cmd_exception ("--jobs: expected a positive number");
+                    }
+                } else if (clo == "drug-integration") {
+                    string arg = parseNextArg (argc, argv, i);
+                    if( arg == "gauss-legendre" ){
+                        options.set (DRUG_INTEGRATION_GL);
+                    }else if( arg == "qag" ){
+                        options.reset (DRUG_INTEGRATION_GL);
+                    }else{
+                        throw cmd_exception ("--drug-integration: expected qag or gauss-legendre");
+                    }
+                } else if (clo == "output-format") {
+                    string arg = parseNextArg (argc, argv, i);
+                    if( arg == "binary" ){
+                        options.set (BINARY_OUTPUT);
+                    }else if( arg == "text" ){
+                        options.reset (BINARY_OUTPUT);
+                    }else{
+                        throw cmd_exception ("--output-format: expected text or binary");
+                    }
                 } else if (clo == "name") {
                     if (ctsoutName != "" || outputName != "" || scenarioFile != ""){
                         throw cmd_exception ("--name may not be used along with --scenario, --output or --ctsout");
                     }
                     string name = parseNextArg (argc, argv, i);
                     (scenarioFile = "scenario").append(name).append(".xml");
-                    (outputName = "output").append(name).append(".txt");
+                    (outputName = "output").append(name);    // extension added below
                     (ctsoutName = "ctsout").append(name).append(".txt");
+                    cloName = true;
                 } else if (clo == "validate-only") {
                     options.set (SKIP_SIMULATION);
                 } else if (clo == "deprecation-warnings") {
@@ -120,8 +196,52 @@ namespace OM { namespace util {
                 } else if (clo == "checkpoint-stop") {
 		    options.set (CHECKPOINT);
                     options.set (CHECKPOINT_STOP);
+                } else if (clo == "checkpoint-steps") {
+                    string arg = parseNextArg (argc, argv, i);
+                    try{
+                        int n = lexical_cast<int>(arg);
+                        if( n < 1 ) throw cmd_exception ("--checkpoint-steps: expected a positive number");
+                        checkpointSteps = n;
+                    }catch( boost::bad_lexical_cast& ){
+                        throw cmd_exception ("--checkpoint-steps: expected a positive number");
+                    }
+                } else if (clo == "checkpoint-minutes") {
+                    string arg = parseNextArg (argc, argv, i);
+                    try{
+                        checkpointMinutes = lexical_cast<double>(arg);
+                        if( !(checkpointMinutes > 0.0) ) throw cmd_exception ("--checkpoint-minutes: expected a positive number");
+                    }catch( boost::bad_lexical_cast& ){
+                        throw cmd_exception ("--checkpoint-minutes: expected a positive number");
+                    }
+                } else if (clo == "checkpoint-compression") {
+                    string arg = parseNextArg (argc, argv, i);
+                    if( arg == "none" ){
+                        options.set (CHECKPOINT_UNCOMPRESSED);
+                    }else if( arg == "gzip" ){
+                        options.reset (CHECKPOINT_UNCOMPRESSED);
+                    }else{
+                        throw cmd_exception ("--checkpoint-compression: expected gzip or none");
+                    }
+                } else if (clo == "warmup-cache") {
+                    if (warmupCacheDir != ""){
+                        throw cmd_exception ("--warmup-cache argument may only be given once");
+                    }
+                    warmupCacheDir = parseNextArg (argc, argv, i);
+                } else if (clo == "branch") {
+                    branches.push_back( parseNextArg (argc, argv, i) );
                 } else if (clo == "debug-vector-fitting") {
                     options.set (DEBUG_VECTOR_FITTING);
+                } else if (clo == "fast-vector-warmup") {
+                    options.set (FAST_VECTOR_WARMUP);
+                } else if (clo == "vector-warmup-sample") {
+                    string arg = parseNextArg (argc, argv, i);
+                    try{
+                        int n = lexical_cast<int>(arg);
+                        if( n < 1 ) throw cmd_exception ("--vector-warmup-sample: expected a positive number");
+                        vectorWarmupSample = n;
+                    }catch( boost::bad_lexical_cast& ){
+                        throw cmd_exception ("--vector-warmup-sample: expected a positive number");
+                    }
 #	ifdef OM_STREAM_VALIDATOR
 		} else if (clo == "stream-validator") {
 		    if (sVFile.size())
@@ -163,8 +283,9 @@ namespace OM { namespace util {
                         }
                         string name = parseNextArg (argc, argv, i);
                         (scenarioFile = "scenario").append(name).append(".xml");
-                        (outputName = "output").append(name).append(".txt");
+                        (outputName = "output").append(name);    // extension added below
                         (ctsoutName = "ctsout").append(name).append(".txt");
+                        cloName = true;
 		    } else if (clo[j] == 'c') {
 			options.set (CHECKPOINT);
                     } else if (clo[j] == 'v') {
@@ -206,8 +327,32 @@ namespace OM { namespace util {
 	    << " -o --output file.txt	Uses file.txt as output file name. If not given, output.txt is used." << endl
 	    << "    --ctsout file.txt	Uses file.txt as ctsout file name. If not given, ctsout.txt is used." << endl
 	    << " -n --name NAME		Equivalent to --scenario scenarioNAME.xml --output outputNAME.txt \\"<<endl
-	    << "			--ctsout ctsoutNAME.txt" <<endl
+	    << "			--ctsout ctsoutNAME.txt (outputNAME.bin with binary output)" <<endl
 	    << " -z --compress-output	Compress output with gzip (writes output.txt.gz)." << endl
+	    << "    --output-format FORMAT" << endl
+	    << "			Format of survey output: text (default) or binary (columnar;"<<endl
+	    << "			default file name output.bin). util/binaryOutput.py converts"<<endl
+	    << "			binary output to text." << endl
+	    << "    --threads N		Update humans using N threads (default 1). Results do not" << endl
+	    << "			depend on the number of threads." << endl
+	    << "    --drug-integration METHOD" << endl
+	    << "			Method used to integrate killing functions of three-compartment" << endl
+	    << "			and conversion drug models: qag (default; adaptive) or" << endl
+	    << "			gauss-legendre (fixed rule, falling back to qag where needed;" << endl
+	    << "			faster, results differ slightly)." << endl
+	    << "    --fast-vector-warmup" << endl
+	    << "			Fit vector emergence by solving for the periodic steady state"<<endl
+	    << "			of the mosquito population, driven by the human population of"<<endl
+	    << "			the last warm-up year, instead of simulating fitting rounds of"<<endl
+	    << "			six years. Prints how closely the fit matches its target. With"<<endl
+	    << "			--debug-vector-fitting, classic fitting rounds follow and the"<<endl
+	    << "			difference they make to the fit is printed."<<endl
+	    << "    --vector-warmup-sample N"<<endl
+	    << "			Simulate vector fitting rounds with a sample of N humans,"<<endl
+	    << "			stratified by age and availability, then the final year of"<<endl
+	    << "			vector warm-up with the whole population. Prints how far the"<<endl
+	    << "			fitted emergence is from that of --fast-vector-warmup on the"<<endl
+	    << "			whole population."<<endl
 	    << "    --validate-only	Initialise and validate scenario, but don't run simulation." << endl
 	    << "    --deprecation-warnings" << endl
 	    << "			Warn about the use of features deemed error-prone and where" << endl
@@ -229,6 +374,36 @@ namespace OM { namespace util {
 	    << "			This may be used to skip redundant computation when multiple"<<endl
 	    << "			simulations differ only during the intervention phase."<<endl
 	    << "    --checkpoint-stop	Checkpoint as above, then stop immediately afterwards."<<endl
+	    << "    --checkpoint-steps N"<<endl
+	    << "			During the main phase, checkpoint every N time steps. Checkpoints"<<endl
+	    << "			are compressed and written in the background. A simulation"<<endl
+	    << "			resumes from the latest checkpoint when restarted."<<endl
+	    << "    --checkpoint-minutes M"<<endl
+	    << "			As above, but checkpoint when M minutes of run time have passed"<<endl
+	    << "			since the last checkpoint. If combined with --checkpoint-steps,"<<endl
+	    << "			a checkpoint is written when either is due."<<endl
+	    << "    --checkpoint-compression METHOD"<<endl
+	    << "			Compression of checkpoint files: gzip (default) or none (faster"<<endl
+	    << "			to read and write, but larger). Must be the same when resuming."<<endl
+	    << "    --warmup-cache DIR	Share the warm-up between scenarios differing only in"<<endl
+	    << "			interventions deployed to humans, changeHS, changeEIR, imported"<<endl
+	    << "			infections and survey times. A snapshot of the state at the"<<endl
+	    << "			start of the main phase is stored in DIR, keyed by a hash of"<<endl
+	    << "			the rest of the scenario, and loaded by later runs."<<endl
+	    << "    --branch NAME	Also run scenarioNAME.xml, writing outputNAME.txt and"<<endl
+	    << "			ctsoutNAME.txt. The branch is forked from this process at the"<<endl
+	    << "			start of the main phase, sharing its warm-up. The branch"<<endl
+	    << "			scenario may differ only in interventions deployed to humans,"<<endl
+	    << "			changeHS, changeEIR and imported infections (as with"<<endl
+	    << "			--warmup-cache; survey times are taken from this scenario)."<<endl
+	    << "			May be given several times; branches run concurrently."<<endl
+	    << "    --seeds LIST	Run an ensemble: one replicate of the scenario per seed, in"<<endl
+	    << "			place of the seed given in the scenario. LIST is a comma-"<<endl
+	    << "			separated list of seeds or ranges, e.g. 1-100,200. The scenario"<<endl
+	    << "			is loaded and initialised once; each replicate is a process"<<endl
+	    << "			forked from this one and writes output.S.txt and ctsout.S.txt"<<endl
+	    << "			for seed S (names given by --output/--ctsout are used likewise)."<<endl
+	    << "    --jobs N		Run up to N replicates of an ensemble at once (default 1)."<<endl
 	    << "    --debug-vector-fitting"<<endl
 	    << "			Show details of vector-parameter fitting. The fitting methods used" <<endl
 	    << "			aren't guaranteed to work. If they don't, this output should help"<<endl
@@ -249,15 +424,45 @@ namespace OM { namespace util {
         }
 	
 #	ifdef OM_STREAM_VALIDATOR
+	// validation points are recorded in update order
+	if( numThreads > 1 )
+	    throw cmd_exception ("--threads is not supported in builds with OM_STREAM_VALIDATOR");
 	if( sVFile.size() )
 	    StreamValidator.loadStream( sVFile );
 #	endif
+	parallel::setNumThreads( numThreads );
+	
+	if( vectorWarmupSample > 0 && options.test(FAST_VECTOR_WARMUP) )
+	    throw cmd_exception ("--vector-warmup-sample may not be used along with --fast-vector-warmup");
+	
+	if( branches.size() ){
+#	    if defined(_WIN32) || defined(OM_STREAM_VALIDATOR)
+	    throw cmd_exception ("--branch is not supported by this build");
+#	    endif
+	    if( options.test(CHECKPOINT) || checkpointSteps > 0 || checkpointMinutes > 0.0 )
+		throw cmd_exception ("--branch may not be used along with checkpointing");
+	}
+	if( seeds.size() ){
+#	    if defined(_WIN32) || defined(OM_STREAM_VALIDATOR)
+	    throw cmd_exception ("--seeds is not supported by this build");
+#	    endif
+	    if( options.test(CHECKPOINT) || checkpointSteps > 0 || checkpointMinutes > 0.0 )
+		throw cmd_exception ("--seeds may not be used along with checkpointing");
+	    // the cache is keyed by scenario, which includes the seed
+	    if( warmupCacheDir != "" )
+		throw cmd_exception ("--seeds may not be used along with --warmup-cache");
+	    if( branches.size() )
+		throw cmd_exception ("--seeds may not be used along with --branch");
+	}
 	
         if (scenarioFile == ""){
             scenarioFile = "scenario.xml";
         }
 	if (outputName == ""){
-	    outputName = "output.txt";
+	    outputName = options.test(BINARY_OUTPUT) ? "output.bin" : "output.txt";
+	}else if (cloName){
+	    // --output-format may be given after --name
+	    outputName.append( options.test(BINARY_OUTPUT) ? ".bin" : ".txt" );
 	}
 	if (ctsoutName == ""){
             ctsoutName = "ctsout.txt";
@@ -266,6 +471,30 @@ namespace OM { namespace util {
 	return scenarioFile;
     }
     
+    string CommandLine::getBranchScenario (size_t i) {
+	return lookupResource( string("scenario").append(branches.at(i)).append(".xml") );
+    }
+    void CommandLine::selectBranch (size_t i) {
+	const string& name = branches.at(i);
+	(outputName = "output").append(name).append(
+	    options.test(BINARY_OUTPUT) ? ".bin" : ".txt");
+	(ctsoutName = "ctsout").append(name).append(".txt");
+    }
+    
+    /// Insert suffix before the extension of name (or at the end)
+    string insertSuffix (const string& name, const string& suffix) {
+	size_t dot = name.rfind( '.' );
+	size_t slash = name.find_last_of( "/\\" );
+	if( dot == string::npos || (slash != string::npos && dot < slash) )
+	    return name + suffix;
+	return name.substr( 0, dot ) + suffix + name.substr( dot );
+    }
+    void CommandLine::selectSeed (uint64_t seed) {
+	string suffix = "." + lexical_cast<string>( seed );
+	outputName = insertSuffix( outputName, suffix );
+	ctsoutName = insertSuffix( ctsoutName, suffix );
+    }
+    
     string CommandLine::lookupResource (const string& path) {
 	string ret;
 	if (path.size() >= 1 && path[0] == '/') {
@@ -24,6 +24,7 @@
 #include "Global.h"
 #include <string>
 #include <set>
+#include <vector>
 #include <bitset>
 #include <limits>
 using namespace std;
@@ -61,6 +62,19 @@ namespace OM { namespace util {
             /** Print times of all surveys. */
             PRINT_SURVEY_TIMES,
             PRINT_GENOTYPES,
+            /** Integrate drug killing functions with a Gauss-Legendre rule
+             * instead of QAG (see PkPd/Drug/LSTMIntegration.h). */
+            DRUG_INTEGRATION_GL,
+            /** Write survey output in binary columnar format instead of
+             * text (see mon::internal::writeBinary). */
+            BINARY_OUTPUT,
+            /** Write checkpoints (and warm-up snapshots) without gzip
+             * compression. */
+            CHECKPOINT_UNCOMPRESSED,
+            /** Fit vector emergence to the periodic steady state of the
+             * mosquito model instead of simulating fitting rounds (see
+             * VectorModel::fitEquilibrium). */
+            FAST_VECTOR_WARMUP,
 	    NUM_OPTIONS
 	};
 	
@@ -82,6 +96,59 @@ namespace OM { namespace util {
             return ctsoutName;
         }
         
+        /** Get the directory used to cache warm-up snapshots, or an empty
+         * string if not used. */
+        static inline string getWarmupCacheDir (){
+            return warmupCacheDir;
+        }
+        
+        /** Get the names of branches (see --branch); empty if not used. */
+        static inline const vector<string>& getBranches (){
+            return branches;
+        }
+        
+        /** Get the path of the scenario file of branch i. */
+        static string getBranchScenario (size_t i);
+        
+        /** Switch output file names to those of branch i (as with --name). */
+        static void selectBranch (size_t i);
+        
+        /** Get the seeds of ensemble replicates (see --seeds); empty if
+         * not used. */
+        static inline const vector<uint64_t>& getSeeds (){
+            return seeds;
+        }
+        /** Get the maximum number of ensemble replicates run at once. */
+        static inline size_t getNumJobs (){
+            return numJobs;
+        }
+        
+        /** Switch output file names to those of the replicate with this
+         * seed (e.g. output.txt to output.17.txt). */
+        static void selectSeed (uint64_t seed);
+        
+        /** Get the period of checkpoints during the main phase in time
+         * steps; zero if not used. */
+        static inline size_t getCheckpointSteps (){
+            return checkpointSteps;
+        }
+        /** Get the period of checkpoints during the main phase in minutes
+         * (wall-clock time); zero if not used. */
+        static inline double getCheckpointMinutes (){
+            return checkpointMinutes;
+        }
+        
+        /** Get the number of humans in the sample used for vector fitting
+         * rounds (see --vector-warmup-sample); zero if not used. */
+        static inline size_t getVectorWarmupSample (){
+            return vectorWarmupSample;
+        }
+        
+        /** Get the number of threads to use when updating humans. */
+        static inline size_t getNumThreads (){
+            return numThreads;
+        }
+        
 	/** Looks through all command line options.
 	*
 	* @returns The name of the scenario XML file to use.
@@ -107,6 +174,20 @@ namespace OM { namespace util {
 	//Output filename (for main output file "output.txt")
 	static string outputName;
         static string ctsoutName;
+        static string warmupCacheDir;
+        static vector<string> branches;
+        // Ensemble replicates (see --seeds, --jobs)
+        static vector<uint64_t> seeds;
+        static size_t numJobs;
+        
+        static size_t vectorWarmupSample;
+        
+        // Periodic checkpoints (0: not used)
+        static size_t checkpointSteps;
+        static double checkpointMinutes;
+        
+        // Number of threads used by the human update (1: serial)
+        static size_t numThreads;
     };
 } }
 #endif
@@ -20,6 +20,7 @@
 
 #include "util/DocumentLoader.h"
 #include "util/errors.h"
+#include "util/version.h"
 
 #include <iostream>
 #include <sstream>
@@ -27,8 +28,83 @@
 #include <map>
 #include <boost/format.hpp>
 
+#ifdef OM_SCENARIO_CACHE
+#include <rpc/types.h>
+#include <rpc/xdr.h>
+#include <unistd.h>     // getpid
+#include <cstdio>
+#include <schema/schemaHash.h>
+#endif
+
 namespace OM { namespace util {
 
+/// 64-bit FNV-1a hash of text
+static uint64_t hashText( const string& text ){
+    uint64_t hash = 14695981039346656037ull;
+    for( char c : text ){
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+#ifdef OM_SCENARIO_CACHE
+namespace cache {
+    string header( const string& text ){
+        ostringstream h;
+        h << "OpenMalaria scenario cache 1; schema " << DocumentLoader::SCHEMA_VERSION
+            << ' ' << OM_SCHEMA_HASH
+            << "; version " << util::semantic_version
+            << "; length " << text.size()
+            << "; hash " << hex << hashText( text ) << '\n';
+        return h.str();
+    }
+    
+    unique_ptr<scnXml::Scenario> load( const string& file, const string& header ){
+        unique_ptr<scnXml::Scenario> scenario;
+        FILE *f = fopen( file.c_str(), "rb" );
+        if( f == nullptr ) return scenario;
+        string line( header.size(), '\0' );
+        if( fread( &line[0], 1, line.size(), f ) == line.size() && line == header ){
+            XDR xdr;
+            xdrstdio_create( &xdr, f, XDR_DECODE );
+            try{
+                xsd::cxx::tree::istream<XDR> stream( xdr );
+                scenario.reset( new scnXml::Scenario( stream ) );
+            }catch( const std::exception& ){
+                // truncated or otherwise unreadable: parse the XML instead
+                scenario.reset();
+            }
+            xdr_destroy( &xdr );
+        }
+        fclose( f );
+        return scenario;
+    }
+    
+    void save( const string& file, const string& header, const scnXml::Scenario& scenario ){
+        ostringstream tmp;
+        tmp << file << '.' << getpid() << ".tmp";
+        FILE *f = fopen( tmp.str().c_str(), "wb" );
+        if( f == nullptr ) return;
+        bool ok = fwrite( header.data(), 1, header.size(), f ) == header.size();
+        if( ok ){
+            XDR xdr;
+            xdrstdio_create( &xdr, f, XDR_ENCODE );
+            try{
+                xsd::cxx::tree::ostream<XDR> stream( xdr );
+                stream << scenario;
+            }catch( const std::exception& ){
+                ok = false;
+            }
+            xdr_destroy( &xdr );
+        }
+        ok = (fclose( f ) == 0) && ok;
+        if( !ok || rename( tmp.str().c_str(), file.c_str() ) != 0 )
+            remove( tmp.str().c_str() );
+    }
+}
+#endif
+
 void DocumentLoader::loadDocument (std::string lXmlFile){
     xmlFileName = lXmlFile;
     //Parses the document
@@ -44,8 +120,24 @@ void DocumentLoader::loadDocument (std::string lXmlFile){
 	string msg = "Error: unable to open "+lXmlFile;
 	throw util::xml_scenario_error (msg);
     }
+#ifdef OM_SCENARIO_CACHE
+    ostringstream buf;
+    buf << fileStream.rdbuf();
+    fileStream.close ();
+    const string text = buf.str();
+    const string cacheFile = lXmlFile + ".cache";
+    const string cacheHeader = cache::header( text );
+    scenario = cache::load( cacheFile, cacheHeader );
+    if( scenario == nullptr ){
+        istringstream textStream( text );
+        scenario = scnXml::parseScenario (textStream);
+        // only reached if the document was valid
+        cache::save( cacheFile, cacheHeader, *scenario );
+    }
+#else
     scenario = scnXml::parseScenario (fileStream);
     fileStream.close ();
+#endif
     int scenarioVersion = scenario->getSchemaVersion();
     if (scenarioVersion < SCHEMA_VERSION) {
         // Don't bother aborting. Mostly if something really is incompatible
@@ -57,6 +149,85 @@ void DocumentLoader::loadDocument (std::string lXmlFile){
         throw util::xml_scenario_error ("Error: new schema version unsupported");
 }
 
+namespace warmup {
+    /// Remove comments and collapse whitespace (removing it between elements)
+    string normalise( const string& text ){
+        string out;
+        out.reserve( text.size() );
+        bool space = false;
+        for( size_t i = 0; i < text.size(); ){
+            if( text.compare( i, 4, "<!--" ) == 0 ){
+                size_t end = text.find( "-->", i + 4 );
+                i = (end == string::npos) ? text.size() : end + 3;
+                continue;
+            }
+            char c = text[i++];
+            if( c == ' ' || c == '\t' || c == '\n' || c == '\r' ){
+                space = true;
+                continue;
+            }
+            if( space && c != '<' && !out.empty() && out.back() != '>' )
+                out.push_back( ' ' );
+            space = false;
+            out.push_back( c );
+        }
+        return out;
+    }
+    
+    /// Find the start tag of element name in [begin, end), or string::npos
+    size_t findStart( const string& text, const string& name, size_t begin, size_t end ){
+        string tag = "<" + name;
+        for( size_t i = text.find( tag, begin ); i < end; i = text.find( tag, i + 1 ) ){
+            char next = text[i + tag.size()];
+            if( next == '>' || next == ' ' || next == '/' )
+                return i;
+        }
+        return string::npos;
+    }
+    
+    /** Remove all elements called name (which may not be nested) found
+     * within the first element called parent. */
+    void removeWithin( string& text, const string& parent, const string& name ){
+        size_t pBegin = findStart( text, parent, 0, text.size() );
+        if( pBegin == string::npos ) return;
+        size_t pEnd = text.find( "</" + parent + ">", pBegin );
+        if( pEnd == string::npos ) return;
+        for( size_t i = findStart( text, name, pBegin, pEnd ); i != string::npos;
+                i = findStart( text, name, i, pEnd ) ){
+            size_t tagEnd = text.find( '>', i );
+            size_t end;
+            if( text[tagEnd - 1] == '/' ){     // empty element
+                end = tagEnd + 1;
+            }else{
+                string close = "</" + name + ">";
+                end = text.find( close, tagEnd );
+                if( end == string::npos || end > pEnd )
+                    throw util::xml_scenario_error( "unable to find end of element " + name );
+                end += close.size();
+            }
+            text.erase( i, end - i );
+            pEnd -= end - i;
+        }
+    }
+}
+
+uint64_t DocumentLoader::warmupHash() const {
+    ifstream fileStream (xmlFileName.c_str(), ios::binary);
+    if (!fileStream.good()){
+        throw util::xml_scenario_error ("Error: unable to open "+xmlFileName);
+    }
+    ostringstream buf;
+    buf << fileStream.rdbuf();
+    string text = warmup::normalise( buf.str() );
+    const char *intervs[] = { "human", "changeHS", "changeEIR", "importedInfections" };
+    for( const char *name : intervs ){
+        warmup::removeWithin( text, "interventions", name );
+    }
+    warmup::removeWithin( text, "monitoring", "surveys" );
+    text.append( "\n" ).append( util::semantic_version );
+    return hashText( text );
+}
+
 void DocumentLoader::saveDocument()
 {
     if (documentChanged) {
@@ -40,6 +40,11 @@ public:
     
     /** @brief Reads the document in the xmlFile
     * 
+    * When built with OM_SCENARIO_CACHE, the parsed document is also saved in
+    * binary form to xmlFile.cache, and later runs load that instead of
+    * parsing and validating the XML so long as the XML text, schema (files
+    * and version) and program version are unchanged (see cache::header).
+    * 
     * Throws on failure. */
     void loadDocument(std::string);
     
@@ -47,6 +52,18 @@ public:
         * documentChanged is true. */
     void saveDocument();
     
+    /** Hash of the parts of the scenario document which can affect the
+     * simulation before the main phase (intervention period) starts.
+     * 
+     * This is a hash of the file text, with comments and whitespace between
+     * elements removed and without the human, changeHS, changeEIR and
+     * importedInfections elements of interventions or the surveys element of
+     * monitoring, all of which only take effect in the main phase. The
+     * program version is included. Scenarios differing only in these parts
+     * have the same hash and (given the same command-line options) the same
+     * state at the start of the main phase. */
+    uint64_t warmupHash() const;
+    
     /** Get the base scenario element.
         *
         * Is an operator for brevity: InputData().getModel()...
@@ -79,5 +96,27 @@ private:
     unique_ptr<scnXml::Scenario> scenario;
 };
 
+#ifdef OM_SCENARIO_CACHE
+/// The binary scenario cache used by DocumentLoader::loadDocument
+namespace cache {
+    /** First line of the cache file. The body is only read if this matches
+     * exactly, so it identifies everything the body depends on: the cache
+     * format, the schema version, a build-time hash of the schema files and
+     * the code generator (which determine the layout of the generated scnXml
+     * classes), the program version and the scenario text. */
+    std::string header( const std::string& text );
+    
+    /// Load the cached scenario, or return nullptr if missing or stale
+    unique_ptr<scnXml::Scenario> load( const std::string& file, const std::string& header );
+    
+    /** Write the cache. Failure (e.g. a read-only directory) is not an error:
+     * the XML is simply parsed again next time.
+     * 
+     * The file is written under a temporary name then renamed, so that
+     * concurrent runs never read a partial cache. */
+    void save( const std::string& file, const std::string& header, const scnXml::Scenario& scenario );
+}
+#endif
+
 } }
 #endif
@@ -0,0 +1,121 @@
+/* This file is part of OpenMalaria.
+ *
+ * Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ * Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+ *
+ * OpenMalaria is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "util/arena.h"
+#include "util/parallel.h"
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace OM { namespace util { namespace arena {
+using std::vector;
+
+namespace {
+
+const size_t ALIGN = alignof(std::max_align_t);
+// Objects larger than this use the normal heap (none expected)
+const size_t MAX_POOLED = 4096;
+const size_t BLOCK_SIZE = 1 << 20;
+
+inline size_t roundUp( size_t size ){
+    return (size + ALIGN - 1) / ALIGN * ALIGN;
+}
+
+class Arena {
+public:
+    Arena() : freeLists( MAX_POOLED / ALIGN + 1 ), next(0), end(0), inUse(0) {}
+
+    void* allocate( size_t size ){
+        assert( !parallel::deferring() );
+        size = roundUp( size );
+        inUse += size;
+        if( size > MAX_POOLED ) return ::operator new( size );
+        vector<void*>& list = freeLists[size / ALIGN];
+        if( !list.empty() ){
+            void* p = list.back();
+            list.pop_back();
+            return p;
+        }
+        if( static_cast<size_t>(end - next) < size ) newBlock( BLOCK_SIZE );
+        void* p = next;
+        next += size;
+        return p;
+    }
+
+    void deallocate( void* p, size_t size ){
+        assert( !parallel::deferring() );
+        if( p == 0 ) return;
+        size = roundUp( size );
+        inUse -= size;
+        if( size > MAX_POOLED ){
+            ::operator delete( p );
+            return;
+        }
+        freeLists[size / ALIGN].push_back( p );
+    }
+
+    void reserve( size_t bytes ){
+        bytes = roundUp( bytes );
+        if( static_cast<size_t>(end - next) < bytes ){
+            newBlock( bytes > BLOCK_SIZE ? bytes : BLOCK_SIZE );
+        }
+    }
+
+    size_t bytesInUse() const{ return inUse; }
+
+private:
+    // Start a new block. Any space left in the current block is abandoned.
+    void newBlock( size_t size ){
+        // ::operator new returns memory aligned for any object
+        blocks.push_back( static_cast<char*>( ::operator new( size ) ) );
+        next = blocks.back();
+        end = next + size;
+    }
+
+    vector<vector<void*>> freeLists;    // by size / ALIGN
+    vector<char*> blocks;
+    char *next, *end;   // free space in the last block
+    size_t inUse;
+};
+
+Arena& instance(){
+    // Constructed on first use and never destroyed, so that objects owned by
+    // other statics can still be freed during exit.
+    static Arena *arena = new Arena;
+    return *arena;
+}
+}
+
+void* allocate( size_t size ){
+    return instance().allocate( size );
+}
+void deallocate( void* p, size_t size ) noexcept{
+    instance().deallocate( p, size );
+}
+void reserve( size_t bytes ){
+    instance().reserve( bytes );
+}
+size_t bytesInUse(){
+    return instance().bytesInUse();
+}
+
+} } }
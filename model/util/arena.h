@@ -0,0 +1,68 @@
+/* This file is part of OpenMalaria.
+ *
+ * Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ * Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+ *
+ * OpenMalaria is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef Hmod_util_arena
+#define Hmod_util_arena
+
+#include <cstddef>
+
+/** Pooled allocation for the per-human sub-models (within-host, clinical and
+ * infection-incidence models).
+ *
+ * Objects are carved from large blocks in order of allocation, so the models
+ * belonging to one human (created one after another in the Human constructor)
+ * lie next to each other rather than scattered over the heap. Freed objects
+ * go on a free list per size class and are reused last-freed-first: a human
+ * born after another dies thus usually takes over the whole group of slots.
+ * Memory is kept for reuse and only released by the OS at exit.
+ *
+ * Humans are only created and destroyed on the main thread (not within
+ * util::parallel::forChunks()); the arena is not thread-safe. */
+namespace OM { namespace util { namespace arena {
+
+/// Allocate size bytes (aligned as for any object)
+void* allocate( size_t size );
+/// Free memory from allocate(); size must be as passed to allocate()
+void deallocate( void* p, size_t size ) noexcept;
+
+/** Make sure at least the given number of bytes can be allocated without
+ * allocating a new block (for creating many humans at once). */
+void reserve( size_t bytes );
+
+/// Total bytes currently allocated (excluding free slots)
+size_t bytesInUse();
+
+}
+
+/** Base class of per-human sub-models: class-level operator new and delete
+ * use the arena. Deleting through a base pointer is fine as long as the
+ * destructor is virtual (the size of the dynamic type is then passed). */
+class ArenaObject {
+public:
+    static void* operator new( size_t size ){
+        return arena::allocate( size );
+    }
+    static void operator delete( void* p, size_t size ) noexcept{
+        arena::deallocate( p, size );
+    }
+};
+
+} }
+#endif
@@ -26,6 +26,9 @@
 // otherwise "using ..." declaration in Global.h won't work
 #endif
 
+#include "util/errors.h"
+#include <type_traits>
+
 /** Provides some extra functions. See checkpoint.h. */
 namespace OM {
 namespace util {
@@ -50,12 +53,42 @@ namespace checkpoint {
         x.second & stream;
     }
     
+    namespace impl {
+        // Elements of arithmetic type (except bool: vector<bool> is packed)
+        // can be written in a single call; the format is the same.
+        template<class T>
+        struct isBulk : integral_constant<bool,
+            is_arithmetic<T>::value && !is_same<T,bool>::value> {};
+        
+        template<class T>
+        void writeElements (vector<T>& x, ostream& stream, false_type) {
+            foreach (T& y, x) {
+                y & stream;
+            }
+        }
+        template<class T>
+        void writeElements (vector<T>& x, ostream& stream, true_type) {
+            stream.write (reinterpret_cast<const char*>(x.data()), x.size() * sizeof(T));
+        }
+        template<class T>
+        void readElements (vector<T>& x, istream& stream, false_type) {
+            foreach (T& y, x) {
+                y & stream;
+            }
+        }
+        template<class T>
+        void readElements (vector<T>& x, istream& stream, true_type) {
+            streamsize len = x.size() * sizeof(T);
+            stream.read (reinterpret_cast<char*>(x.data()), len);
+            if (!stream || stream.gcount() != len)
+                throw checkpoint_error ("stream read error vector");
+        }
+    }
+    
     template<class T>
     void operator& (vector<T>& x, ostream& stream) {
         x.size() & stream;
-        foreach (T& y, x) {
-            y & stream;
-        }
+        impl::writeElements (x, stream, impl::isBulk<T>());
     }
     template<class T>
     void operator& (vector<T>& x, istream& stream) {
@@ -63,9 +96,7 @@ namespace checkpoint {
         l & stream;
         validateListSize (l);
         x.resize (l);
-        foreach (T& y, x) {
-            y & stream;
-        }
+        impl::readElements (x, stream, impl::isBulk<T>());
     }
     /// Version of above taking an element to initialize each element from.
     template<class T>
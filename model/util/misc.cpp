@@ -46,15 +46,6 @@ SimDate sim::s_end;
 
 SimTime sim::s_max_human_age;
 
-// Global variables
-#ifndef NDEBUG
-bool sim::in_update = false;
-#endif
-SimTime sim::s_t0;
-SimTime sim::s_t1;
-
-SimTime sim::s_interv;
-
 using util::CommandLine;
 
 
@@ -263,7 +254,7 @@ void sim::init( const scnXml::Scenario& scenario ){
         }
     }
     
-    sim::s_interv = SimTime::never();    // large negative number
+    sim::s_clock->interv = SimTime::never();     // large negative number
     
     sim::s_end = mon::readSurveyDates( mon );
 }
@@ -0,0 +1,177 @@
+/* This file is part of OpenMalaria.
+ *
+ * Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ * Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+ *
+ * OpenMalaria is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "util/parallel.h"
+#include "SimContext.h"
+
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace OM { namespace util { namespace parallel {
+using std::vector;
+
+thread_local vector<Deferred> *impl::deferred = 0;
+thread_local size_t impl::chunk = 0;
+
+namespace {
+
+/* Worker threads are started on first use and kept until exit, so that
+ * thread-local caches (e.g. GSL workspaces) survive between time steps. */
+class Pool {
+public:
+    Pool() : nThreads(1), generation(0), pending(0), stopping(false),
+        job(0), jobSize(0), context(0) {}
+    ~Pool(){ stop(); }
+
+    void setNumThreads( size_t n ){
+        assert( !deferring() );
+        if( n < 1 ) n = 1;
+        if( n == nThreads ) return;
+        stop();
+        nThreads = n;
+    }
+    size_t numThreads() const{ return nThreads; }
+
+    void run( size_t n, const std::function<void(size_t,size_t)>& f ){
+        // Single thread, or already within a chunk: no need for workers.
+        if( nThreads == 1 || deferring() ){
+            f( 0, n );
+            return;
+        }
+        start();
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            job = &f;
+            jobSize = n;
+            context = &SimContext::current();
+            pending = nThreads - 1;
+            ++generation;
+        }
+        cvStart.notify_all();
+        runChunk( 0 );
+        {
+            std::unique_lock<std::mutex> lock( mutex );
+            while( pending > 0 ) cvDone.wait( lock );
+            job = 0;
+        }
+
+        for( size_t i = 0; i < nThreads; ++i ){
+            if( errors[i] ){
+                std::exception_ptr e = errors[i];
+                for( size_t j = 0; j < nThreads; ++j ){
+                    errors[j] = std::exception_ptr();
+                    logs[j].clear();
+                }
+                std::rethrow_exception( e );
+            }
+        }
+        // Replay logged updates in the order a serial run would make them.
+        for( size_t i = 0; i < nThreads; ++i ){
+            for( const Deferred& d : logs[i] ){
+                d.fn( d.index, d.value );
+            }
+            logs[i].clear();
+        }
+    }
+
+private:
+    void start(){
+        if( !threads.empty() ) return;
+        logs.resize( nThreads );
+        errors.assign( nThreads, std::exception_ptr() );
+        stopping = false;
+        for( size_t i = 1; i < nThreads; ++i ){
+            threads.push_back( std::thread( &Pool::workerLoop, this, i, generation ) );
+        }
+    }
+    void stop(){
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            stopping = true;
+        }
+        cvStart.notify_all();
+        for( std::thread& t : threads ) t.join();
+        threads.clear();
+    }
+
+    void workerLoop( size_t chunk, uint64_t seen ){
+        while( true ){
+            {
+                std::unique_lock<std::mutex> lock( mutex );
+                while( !stopping && generation == seen ) cvStart.wait( lock );
+                if( stopping ) return;
+                seen = generation;
+            }
+            runChunk( chunk );
+            {
+                std::lock_guard<std::mutex> lock( mutex );
+                pending -= 1;
+            }
+            cvDone.notify_one();
+        }
+    }
+
+    void runChunk( size_t chunk ){
+        size_t begin = jobSize * chunk / nThreads;
+        size_t end = jobSize * (chunk + 1) / nThreads;
+        impl::deferred = &logs[chunk];
+        impl::chunk = chunk;
+        if( chunk > 0 ) SimContext::bind( *context );  // caller's simulation
+        try{
+            (*job)( begin, end );
+        }catch( ... ){
+            errors[chunk] = std::current_exception();
+        }
+        impl::deferred = 0;
+    }
+
+    size_t nThreads;
+    vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable cvStart, cvDone;
+    uint64_t generation;        // incremented to start a job
+    size_t pending;     // number of worker chunks not yet finished
+    bool stopping;
+    const std::function<void(size_t,size_t)> *job;
+    size_t jobSize;
+    SimContext *context;        // of the thread calling run()
+    vector<vector<Deferred>> logs;      // per chunk
+    vector<std::exception_ptr> errors;  // per chunk
+};
+
+Pool pool;
+}
+
+void setNumThreads( size_t n ){
+    pool.setNumThreads( n );
+}
+size_t numThreads(){
+    return pool.numThreads();
+}
+
+void forChunks( size_t n, const std::function<void(size_t,size_t)>& f ){
+    pool.run( n, f );
+}
+
+} } }
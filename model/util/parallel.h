@@ -0,0 +1,97 @@
+/* This file is part of OpenMalaria.
+ *
+ * Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ * Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+ *
+ * OpenMalaria is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef Hmod_util_parallel
+#define Hmod_util_parallel
+
+#include <cstddef>
+#include <vector>
+#include <functional>
+
+/** Support for updating humans on several threads.
+ *
+ * Each human carries its own random number generator, so the per-human update
+ * can run in any order. What cannot is anything touching process-wide state:
+ * monitoring accumulators, the adult EIR sum, infant mortality counters, etc.
+ * Such updates go through accumulate(): on the main thread this applies the
+ * update immediately; on a worker the update is logged and applied by the
+ * main thread once all workers have finished. Chunks are contiguous ranges
+ * and logs are replayed in chunk order, so updates are applied in exactly
+ * the same order as in a serial run (this matters for floating-point sums)
+ * and output is identical regardless of the number of threads. */
+namespace OM { namespace util { namespace parallel {
+
+/** Function applying one update to some process-wide accumulator. Meaning
+ * of index and value is defined by the function. */
+typedef void (*AccumulateFn)( size_t index, double value );
+
+/// A logged call to an AccumulateFn
+struct Deferred {
+    AccumulateFn fn;
+    size_t index;
+    double value;
+};
+
+namespace impl {
+    /// Log of the calling thread while running a chunk, otherwise null.
+    extern thread_local std::vector<Deferred> *deferred;
+    /// Index of the chunk being run by the calling thread.
+    extern thread_local size_t chunk;
+}
+
+/** Set the number of threads used by forChunks(). Default is 1: everything
+ * runs serially on the calling thread. Must not be called from forChunks(). */
+void setNumThreads( size_t n );
+/// Get the number of threads used by forChunks()
+size_t numThreads();
+
+/** True while running a chunk of forChunks(), in which case updates to
+ * process-wide state must be deferred. */
+inline bool deferring(){
+    return impl::deferred != 0;
+}
+/** Index of the chunk being run, in [0, numThreads()). Only valid when
+ * deferring() is true. Can be used to index per-thread data which is
+ * combined in a fixed order afterwards. */
+inline size_t chunkIndex(){
+    return impl::chunk;
+}
+/** Log an update for application after forChunks() completes. Only valid
+ * when deferring() is true. */
+inline void defer( AccumulateFn fn, size_t index, double value ){
+    impl::deferred->push_back( Deferred{ fn, index, value } );
+}
+/** Call fn(index, value) now, or once forChunks() completes if called from
+ * a chunk. */
+inline void accumulate( AccumulateFn fn, size_t index, double value ){
+    if( deferring() ) defer( fn, index, value );
+    else fn( index, value );
+}
+
+/** Call f(begin, end) on contiguous chunks of [0, n), one per thread; the
+ * first chunk runs on the calling thread.
+ *
+ * Returns once all chunks are done and deferred updates have been applied.
+ * If any chunk throws, the exception from the first such chunk is rethrown
+ * (after all chunks finish; deferred updates are then discarded). */
+void forChunks( size_t n, const std::function<void(size_t,size_t)>& f );
+
+} } }
+#endif
@@ -39,6 +39,12 @@
 // Unfortunately the authors do not support reproducibility of results.
 // #define OM_RANDOM_USE_BOOST_DIST
 
+// Inline samplers (util/samplers.h) for the normal, gamma, log-normal, beta,
+// Poisson and Weibull distributions, instead of GSL. Faster, but results
+// differ from those of the default build. Set by the CMake option
+// OM_RANDOM_INLINE_DIST.
+// #define OM_RANDOM_USE_INLINE_DIST
+
 #include "Global.h"
 #include "util/errors.h"
 #include <set>
@@ -62,6 +68,10 @@
 #include <gsl/gsl_randist.h>
 #endif
 
+#ifdef OM_RANDOM_USE_INLINE_DIST
+#include "util/samplers.h"
+#endif
+
 #include <cmath>
 
 namespace OM { namespace util {
@@ -93,6 +103,90 @@ gsl_rng_type make_gsl_rng_type(T& rng) {
     };
 }
 
+namespace impl {
+/** Batched generation of uniform [0,1) variates, giving exactly the values
+ * of repeated calls to boost::random::uniform_01 (i.e. RNG::uniform_01()).
+ * 
+ * The generic version simply loops; that for pcg32 is specialised below. */
+template<class T>
+struct Batch {
+    static void fill_uniform_01( T& rng, double* out, size_t n ){
+        boost::random::uniform_01<T&> dist( rng );
+        for( size_t i = 0; i < n; ++i ) out[i] = dist();
+    }
+    /// Draw out[i] from engineOf(i) for i in [0, n)
+    template<class F>
+    static void uniform_01_each( F engineOf, double* out, size_t n ){
+        for( size_t i = 0; i < n; ++i ){
+            boost::random::uniform_01<T&> dist( engineOf(i) );
+            out[i] = dist();
+        }
+    }
+};
+
+/* pcg32 with access to the engine state (protected members). We only use
+ * this to read and write the state of pcg32 objects. */
+struct Pcg32Access : public pcg32 {
+    static inline uint64_t& state( pcg32& e ){
+        return e.*(&Pcg32Access::state_);
+    }
+    static inline uint64_t incrementOf( const pcg32& e ){
+        return (e.*(&Pcg32Access::increment))();
+    }
+    static constexpr uint64_t mult = pcg32::multiplier();
+};
+
+/* pcg32 output function (XSH RR) converted to [0,1) as uniform_01 does:
+ * max - min + 1 = 2^32, so the conversion is exact. */
+inline double pcg32_uniform_01( uint64_t s ){
+    uint32_t x = static_cast<uint32_t>( ((s >> 18u) ^ s) >> 27u );
+    uint32_t rot = static_cast<uint32_t>( s >> 59u );
+    x = (x >> rot) | (x << ((-rot) & 31u));
+    return x * (1.0 / 4294967296.0);
+}
+
+template<>
+struct Batch<pcg32> {
+    /* Lane i generates elements i, i+4, i+8, ...: states four steps apart
+     * are related by s' = s * a^4 + c (a^3 + a^2 + a + 1), so lanes are
+     * independent (no dependency chain between consecutive outputs). */
+    static void fill_uniform_01( pcg32& rng, double* out, size_t n ){
+        uint64_t& state = Pcg32Access::state( rng );
+        const uint64_t a = Pcg32Access::mult, c = Pcg32Access::incrementOf( rng );
+        size_t i = 0;
+        if( n >= 8 ){
+            const uint64_t a4 = a * a * a * a;
+            const uint64_t c4 = c * (a * a * a + a * a + a + 1);
+            uint64_t s[4];
+            s[0] = state;
+            for( int j = 1; j < 4; ++j ) s[j] = s[j-1] * a + c;
+            for( ; i + 4 <= n; i += 4 ){
+                for( int j = 0; j < 4; ++j ){
+                    out[i + j] = pcg32_uniform_01( s[j] );
+                    s[j] = s[j] * a4 + c4;
+                }
+            }
+            state = s[0];       // state for element i
+        }
+        for( ; i < n; ++i ){
+            out[i] = pcg32_uniform_01( state );
+            state = state * a + c;
+        }
+    }
+    
+    template<class F>
+    static void uniform_01_each( F engineOf, double* out, size_t n ){
+        const uint64_t a = Pcg32Access::mult;
+        for( size_t i = 0; i < n; ++i ){
+            pcg32& e = engineOf(i);
+            uint64_t& s = Pcg32Access::state( e );
+            out[i] = pcg32_uniform_01( s );
+            s = s * a + Pcg32Access::incrementOf( e );
+        }
+    }
+};
+}
+
 /// Our random number generator.
 template<class T>
 struct RNG {
@@ -157,12 +251,52 @@ struct RNG {
         return rng_uniform01 ();
     }
     
+    /** Fill out[0..n) with random numbers in the range [0,1); exactly the
+     * numbers n calls to uniform_01() would return, but faster. */
+    inline void fill_uniform_01 (double* out, size_t n) {
+        impl::Batch<T>::fill_uniform_01( m_rng, out, n );
+    }
+    
+    /** Fill out[0..n) with Gaussian random variates; equivalent to n calls
+     * to gauss(mean, std). (Sampling is not batched since GSL's method is
+     * a rejection method; this saves only call overhead.) */
+    inline void fill_gauss (double* out, size_t n, double mean, double std) {
+        for( size_t i = 0; i < n; ++i ) out[i] = gauss( mean, std );
+    }
+    
+    /** Set out[i] = rngs[i]->uniform_01() for i in [0, n).
+     * 
+     * Draws from several RNGs at once, e.g. one per human. */
+    static void uniform_01_each (RNG* const* rngs, double* out, size_t n) {
+        impl::Batch<T>::uniform_01_each(
+            [rngs]( size_t i ) -> T& { return rngs[i]->m_rng; }, out, n );
+    }
+    
+    /** Set out[i] = rngs[i]->bernoulli(prob) for i in [0, n). */
+    static void bernoulli_each (RNG* const* rngs, double prob, bool* out, size_t n) {
+# ifdef OM_RANDOM_USE_BOOST_DIST
+        for( size_t i = 0; i < n; ++i ) out[i] = rngs[i]->bernoulli( prob );
+# else
+        assert( (boost::math::isfinite)(prob) );
+        // chunks, to avoid allocation
+        const size_t CHUNK = 256;
+        double u[CHUNK];
+        for( size_t i = 0; i < n; i += CHUNK ){
+            size_t m = std::min( CHUNK, n - i );
+            uniform_01_each( rngs + i, u, m );
+            for( size_t j = 0; j < m; ++j ) out[i + j] = u[j] < prob;
+        }
+# endif
+    }
+    
     /** This function returns a Gaussian random variate, with mean mean and
      * standard deviation std. The sampled value x ~ N(mean, std^2) . */
     double gauss (double mean, double std){
 # ifdef OM_RANDOM_USE_BOOST_DIST
         boost::random::normal_distribution<> dist (mean, std);
         return dist(m_rng);
+# elif defined OM_RANDOM_USE_INLINE_DIST
+        return samplers::gauss(m_rng) * std + mean;
 # else
         return gsl_ran_gaussian(&m_gsl_gen,std)+mean;
 # endif
@@ -173,6 +307,8 @@ struct RNG {
 # ifdef OM_RANDOM_USE_BOOST_DIST
         boost::random::gamma_distribution<> dist (a, b);
         return dist(m_rng);
+# elif defined OM_RANDOM_USE_INLINE_DIST
+        return samplers::gamma(m_rng, a, b);
 # else
         return gsl_ran_gamma(&m_gsl_gen, a, b);
 # endif
@@ -190,6 +326,8 @@ struct RNG {
 # ifdef OM_RANDOM_USE_BOOST_DIST
         boost::random::lognormal_distribution<> dist (meanlog, stdlog);
         return dist (m_rng);
+# elif defined OM_RANDOM_USE_INLINE_DIST
+        return samplers::log_normal (m_rng, meanlog, stdlog);
 # else
         return gsl_ran_lognormal (&m_gsl_gen, meanlog, stdlog);
 # endif
@@ -232,6 +370,8 @@ struct RNG {
 # ifdef OM_RANDOM_USE_BOOST_DIST
         boost::random::beta_distribution<> dist (a, b);
         return dist(m_rng);
+# elif defined OM_RANDOM_USE_INLINE_DIST
+        return samplers::beta (m_rng,a,b);
 # else
         return gsl_ran_beta (&m_gsl_gen,a,b);
 # endif
@@ -254,6 +394,8 @@ struct RNG {
 # ifdef OM_RANDOM_USE_BOOST_DIST
         boost::random::poisson_distribution<> dist (lambda);
         return dist(m_rng);
+# elif defined OM_RANDOM_USE_INLINE_DIST
+        return samplers::poisson (m_rng, lambda);
 # else
         return gsl_ran_poisson (&m_gsl_gen, lambda);
 # endif
@@ -291,6 +433,8 @@ struct RNG {
 # ifdef OM_RANDOM_USE_BOOST_DIST
         boost::random::weibull_distribution<> dist (k, lambda);
         return dist(m_rng);
+# elif defined OM_RANDOM_USE_INLINE_DIST
+        return samplers::weibull( m_rng, lambda, k );
 # else
         return gsl_ran_weibull( &m_gsl_gen, lambda, k );
 # endif
@@ -308,9 +452,7 @@ private:
 // I would prefer to use pcg64, but MSVC mysteriously fails
 typedef RNG<pcg32> LocalRng;
 typedef RNG<ChaCha<8>> MasterRng;
-
-/// The master RNG, used only for seeding local RNGs
-extern MasterRng master_RNG;
+// The master RNG is SimContext::masterRng
 
 } }
 #endif
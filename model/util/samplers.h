@@ -0,0 +1,216 @@
+/* This file is part of OpenMalaria.
+ *
+ * Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ * Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+ *
+ * OpenMalaria is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OM_util_samplers
+#define OM_util_samplers
+
+/* Header-only distribution samplers, templated on the engine.
+ *
+ * GSL samples through a gsl_rng, which calls our engine through a function
+ * pointer for every uniform it needs; none of this can be inlined. These
+ * samplers call the engine directly:
+ *
+ * -    normal: the ziggurat method of Marsaglia and Tsang (2000), 128 layers
+ * -    gamma: Marsaglia and Tsang (2000), with the usual boost for shape < 1
+ * -    Poisson: PTRS, transformed rejection with squeeze (Hörmann, 1993) for
+ *      lambda >= 10, otherwise multiplication of uniforms
+ * -    log-normal, beta and Weibull: derived from the above or by inversion
+ *
+ * They are used by util::RNG when compiled with OM_RANDOM_USE_INLINE_DIST.
+ * Samples follow the same distributions as GSL's but are not the same
+ * numbers, so results are not comparable with those of a GSL build.
+ *
+ * The engine must return 32 uniformly-distributed bits (pcg32, ChaCha).
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+namespace OM { namespace util { namespace samplers {
+
+namespace impl {
+    template<class E>
+    inline uint32_t bits32( E& engine ){
+        static_assert( E::min() == 0 && E::max() == 0xFFFFFFFFu,
+                "samplers require an engine returning 32 bits" );
+        return static_cast<uint32_t>( engine() );
+    }
+
+    /// Ziggurat layer tables: boundaries (kn), widths (wn), densities (fn)
+    struct Ziggurat {
+        static constexpr double R = 3.442619855899;    // start of the tail
+        int32_t kn[128];
+        double wn[128], fn[128];
+
+        Ziggurat() {
+            const double m1 = 2147483648.0;    // 2^31
+            const double vn = 9.91256303526217e-3;     // area of each layer
+            double dn = R, tn = R;
+            double q = vn / std::exp( -0.5 * dn * dn );
+            kn[0] = static_cast<int32_t>( (dn / q) * m1 );
+            kn[1] = 0;
+            wn[0] = q / m1;
+            wn[127] = dn / m1;
+            fn[0] = 1.0;
+            fn[127] = std::exp( -0.5 * dn * dn );
+            for( int i = 126; i >= 1; --i ){
+                dn = std::sqrt( -2.0 * std::log( vn / dn + std::exp( -0.5 * dn * dn ) ) );
+                kn[i + 1] = static_cast<int32_t>( (dn / tn) * m1 );
+                tn = dn;
+                fn[i] = std::exp( -0.5 * dn * dn );
+                wn[i] = dn / m1;
+            }
+        }
+
+        static const Ziggurat& get() {
+            static const Ziggurat tables;
+            return tables;
+        }
+    };
+}
+
+/// Uniform on [0,1), 32 bits of resolution
+template<class E>
+inline double uniform_01( E& engine ){
+    return impl::bits32( engine ) * (1.0 / 4294967296.0);
+}
+
+/// Uniform on (0,1), safe to take the log of
+template<class E>
+inline double uniform_pos( E& engine ){
+    return (impl::bits32( engine ) + 0.5) * (1.0 / 4294967296.0);
+}
+
+/// Standard normal variate, N(0, 1)
+template<class E>
+inline double gauss( E& engine ){
+    const impl::Ziggurat& z = impl::Ziggurat::get();
+    for(;;){
+        // The layer comes from the low 7 bits and the value from the other
+        // 25, so the two are independent (Doornik, 2005)
+        const uint32_t u = impl::bits32( engine );
+        const uint32_t iz = u & 127;
+        const int32_t hz = static_cast<int32_t>( u & ~127u );
+        // Fast path (~99% of samples): inside the rectangle of layer iz
+        if( std::abs( static_cast<int64_t>( hz ) ) < z.kn[iz] )
+            return hz * z.wn[iz];
+
+        double x = hz * z.wn[iz];
+        if( iz == 0 ){
+            // Tail beyond R, sampled by Marsaglia's method
+            double y;
+            do{
+                x = -std::log( uniform_pos( engine ) ) * (1.0 / impl::Ziggurat::R);
+                y = -std::log( uniform_pos( engine ) );
+            }while( y + y < x * x );
+            return hz > 0 ? impl::Ziggurat::R + x : -impl::Ziggurat::R - x;
+        }
+        // Wedge: accept under the density, else start again
+        if( z.fn[iz] + uniform_01( engine ) * (z.fn[iz - 1] - z.fn[iz])
+                < std::exp( -0.5 * x * x ) )
+            return x;
+    }
+}
+
+/** Gamma variate with shape a and scale b (as gsl_ran_gamma).
+ *
+ * Mean is a b, variance a b^2. */
+template<class E>
+inline double gamma( E& engine, double a, double b ){
+    if( a < 1.0 ){
+        // X ~ Gamma(a+1) then X U^(1/a) ~ Gamma(a)
+        double u = uniform_pos( engine );
+        return gamma( engine, 1.0 + a, b ) * std::pow( u, 1.0 / a );
+    }
+    const double d = a - 1.0 / 3.0;
+    const double c = 1.0 / std::sqrt( 9.0 * d );
+    for(;;){
+        double x, v;
+        do{
+            x = gauss( engine );
+            v = 1.0 + c * x;
+        }while( v <= 0.0 );
+        v = v * v * v;
+        double u = uniform_pos( engine );
+        double x2 = x * x;
+        if( u < 1.0 - 0.0331 * x2 * x2 ) return b * d * v;   // squeeze
+        if( std::log( u ) < 0.5 * x2 + d * (1.0 - v + std::log( v )) )
+            return b * d * v;
+    }
+}
+
+/// Log-normal variate: exp of N(meanlog, stdlog^2)
+template<class E>
+inline double log_normal( E& engine, double meanlog, double stdlog ){
+    return std::exp( meanlog + stdlog * gauss( engine ) );
+}
+
+/// Beta variate with parameters a, b
+template<class E>
+inline double beta( E& engine, double a, double b ){
+    double x = gamma( engine, a, 1.0 );
+    double y = gamma( engine, b, 1.0 );
+    return x / (x + y);
+}
+
+/// Weibull variate with scale lambda and shape k (as gsl_ran_weibull)
+template<class E>
+inline double weibull( E& engine, double lambda, double k ){
+    return lambda * std::pow( -std::log( uniform_pos( engine ) ), 1.0 / k );
+}
+
+/// Poisson variate with mean lambda (which must be finite and non-negative)
+template<class E>
+inline int poisson( E& engine, double lambda ){
+    if( lambda < 10.0 ){
+        // Count uniforms until their product falls below exp(-lambda)
+        const double limit = std::exp( -lambda );
+        int k = 0;
+        double prod = uniform_01( engine );
+        while( prod > limit ){
+            ++k;
+            prod *= uniform_01( engine );
+        }
+        return k;
+    }
+
+    // PTRS; constants from Hörmann (1993), table 1
+    const double slam = std::sqrt( lambda );
+    const double loglam = std::log( lambda );
+    const double b = 0.931 + 2.53 * slam;
+    const double a = -0.059 + 0.02483 * b;
+    const double invalpha = 1.1239 + 1.1328 / (b - 3.4);
+    const double vr = 0.9277 - 3.6224 / (b - 2.0);
+    for(;;){
+        double u = uniform_01( engine ) - 0.5;
+        double v = uniform_pos( engine );
+        double us = 0.5 - std::fabs( u );
+        double k = std::floor( (2.0 * a / us + b) * u + lambda + 0.43 );
+        if( us >= 0.07 && v <= vr ) return static_cast<int>( k );
+        if( k < 0.0 || (us < 0.013 && v > us) ) continue;
+        if( std::log( v ) + std::log( invalpha ) - std::log( a / (us * us) + b )
+                <= -lambda + k * loglam - std::lgamma( k + 1.0 ) )
+            return static_cast<int>( k );
+    }
+}
+
+} } }
+#endif
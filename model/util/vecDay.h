@@ -23,6 +23,7 @@
 
 #include "Global.h"
 #include <vector>
+#include <algorithm>
 
 #if __cplusplus >= 201402L
 // Update classes to mimic std::vector members
@@ -71,6 +72,10 @@ struct vecDay {
     inline ref_t operator[](SimTime n){ return v[n.inDays()]; }
     inline const_ref_t operator[](SimTime n) const{ return v[n.inDays()]; }
     
+    /// Rotate so that the element at n moves to index zero (as std::rotate)
+    inline void rotate(SimTime n){
+        std::rotate( v.begin(), v.begin() + n.inDays(), v.end() ); }
+    
     /// Access
     const vec_t& internal()const{ return v; }
     
@@ -136,6 +141,12 @@ struct vecDay2D {
         return v[n1.inDays() * stride + n2];
     }
     
+    /// Rotate along the first index so that the elements at n1 move to
+    /// index zero (as std::rotate)
+    inline void rotate(SimTime n1){
+        std::rotate( v.begin(), v.begin() + n1.inDays() * stride, v.end() );
+    }
+    
     inline vec_t& internal_vec(){ return v; }
     
     inline void set_all( typename vec_t::value_type x ){
@@ -35,6 +35,7 @@ import subprocess
 import shutil
 from optparse import OptionParser
 import gzip
+import re
 
 sys.path[0]="@CMAKE_SOURCE_DIR@/util"
 import compareOutput
@@ -211,7 +212,11 @@ def runScenario(options,omOptions,name):
     haveMainOut = os.path.isfile(outputFile)
     
     # Compare outputs:
-    if ret == 0 and compare:
+    seeds=ensembleSeeds(omOptions)
+    if ret == 0 and compare and seeds:
+        # an ensemble writes output.S.txt per seed S in place of output.txt
+        ret=compareEnsemble(options,omOptions,seeds,scenarioSrc,simDir)
+    elif ret == 0 and compare:
         # ctsout.txt (this output is optional):
         if haveCtsOut:
             if os.path.isfile(origCtsout):
@@ -252,6 +257,27 @@ def runScenario(options,omOptions,name):
         
         ret=max(ret,ctsret)
         ident=ident and ctsident
+        
+        # outputs of branches (--branch NAME) must match those of scenarioNAME.xml run alone
+        for branch in branchNames(omOptions):
+            branchOutput=os.path.join(simDir,"output%s.txt"%branch)
+            branchCtsout=os.path.join(simDir,"ctsout%s.txt"%branch)
+            if os.path.isfile(branchOutput):
+                bret,bident = compareOutput.main (os.path.join(testSrcDir,"expected/output%s.txt"%branch), branchOutput, 0)
+            else:
+                bret,bident = 1,False
+                print("\033[1;31mNo output 'output%s.txt' from branch" % branch)
+            if os.path.isfile(branchCtsout):
+                cret,cident = compareCtsout.main (os.path.join(testSrcDir,"expected/ctsout%s.txt"%branch), branchCtsout)
+                bret,bident = max(bret,cret), bident and cident
+            ret=max(ret,bret)
+            for f in (branchOutput, branchCtsout):
+                if not os.path.isfile(f):
+                    continue
+                if bident and options.cleanup:
+                    os.remove(f)
+                else:
+                    shutil.move(f, os.path.join(testBuildDir,"branch-"+os.path.basename(f)))
     
     if haveCtsOut:
         shutil.copy2(ctsoutFile, newCtsout)
@@ -270,6 +296,77 @@ def runScenario(options,omOptions,name):
     print("\033[0;00m")
     return ret
 
+# Names given to openMalaria's --branch options
+def branchNames(omOptions):
+    return [omOptions[i+1] for i in range(len(omOptions)-1) if omOptions[i] == "--branch"]
+
+# Seeds given to openMalaria's --seeds option (a list like 1-100,200), if any
+def ensembleSeeds(omOptions):
+    seeds=[]
+    for i in range(len(omOptions)-1):
+        if omOptions[i] != "--seeds":
+            continue
+        for item in omOptions[i+1].split(","):
+            bounds=item.split("-")
+            seeds+=range(int(bounds[0]),int(bounds[-1])+1)
+    return seeds
+
+# Each replicate of an ensemble (--seeds) must give the same output as the
+# scenario run alone with iseed set to the replicate's seed
+def compareEnsemble(options,omOptions,seeds,scenarioSrc,simDir):
+    singleOptions=[]
+    i=0
+    while i < len(omOptions):
+        if omOptions[i] in ("--seeds","--jobs"):
+            i+=2
+        else:
+            singleOptions.append(omOptions[i])
+            i+=1
+    f=open(scenarioSrc)
+    scenario=f.read()
+    f.close()
+    ret=0
+    for seed in seeds:
+        refScenario=os.path.join(simDir,"scenario.%d.xml" % seed)
+        f=open(refScenario,"w")
+        f.write(re.sub(r'iseed="[0-9]+"','iseed="%d"' % seed,scenario))
+        f.close()
+        refOutput="reference.%d.txt" % seed
+        refCtsout="refctsout.%d.txt" % seed
+        cmd=options.wrapArgs+[openMalariaExec,"--deprecation-warnings","--resource-path",os.path.abspath(testSrcDir),"--scenario",refScenario,"--output",refOutput,"--ctsout",refCtsout]+singleOptions
+        if options.logging:
+            print("\033[0;32m  "+(" ".join(cmd))+"\033[0;00m")
+        sret=subprocess.call (cmd, shell=False, cwd=simDir)
+        if sret != 0:
+            print("\033[1;31mNon-zero exit status of single run with seed %d: %d" % (seed,sret))
+            ret=max(ret,1)
+        
+        output=os.path.join(simDir,"output.%d.txt" % seed)
+        ctsout=os.path.join(simDir,"ctsout.%d.txt" % seed)
+        refOutput=os.path.join(simDir,refOutput)
+        refCtsout=os.path.join(simDir,refCtsout)
+        if os.path.isfile(output) and os.path.isfile(refOutput):
+            eret,eident = compareOutput.main (refOutput, output, 0)
+        else:
+            eret,eident = 1,False
+            print("\033[1;31mNo output 'output.%d.txt' from replicate or single run" % seed)
+        if os.path.isfile(ctsout) or os.path.isfile(refCtsout):
+            if os.path.isfile(ctsout) and os.path.isfile(refCtsout):
+                cret,cident = compareCtsout.main (refCtsout, ctsout)
+            else:
+                cret,cident = 1,False
+                print("\033[1;31mNo ctsout 'ctsout.%d.txt' from replicate or single run" % seed)
+            eret,eident = max(eret,cret), eident and cident
+        ret=max(ret,eret)
+        for f in (refScenario, refOutput, refCtsout, output, ctsout):
+            if not os.path.isfile(f):
+                continue
+            if (eident and options.cleanup) or f == refScenario:
+                os.remove(f)
+            else:
+                shutil.move(f, os.path.join(testBuildDir,"ensemble-"+os.path.basename(f)))
+    return ret
+
 def setWrapArgs(option, opt_str, value, parser, *args, **kwargs):
     parser.values.wrapArgs = args[0]
 
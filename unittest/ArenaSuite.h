@@ -0,0 +1,66 @@
+/*
+ This file is part of OpenMalaria.
+ 
+ Copyright (C) 2005-2014 Swiss Tropical and Public Health Institute
+ Copyright (C) 2005-2014 Liverpool School Of Tropical Medicine
+ 
+ OpenMalaria is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or (at
+ your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#ifndef Hmod_ArenaSuite
+#define Hmod_ArenaSuite
+
+#include <cxxtest/TestSuite.h>
+
+#include "util/arena.h"
+#include <cstddef>
+#include <cstdint>
+
+using namespace OM::util;
+
+namespace {
+    struct ArenaBase : public ArenaObject {
+        virtual ~ArenaBase() {}
+        int x;
+    };
+    struct ArenaDerived : public ArenaBase {
+        double y[9];
+    };
+}
+
+class ArenaSuite : public CxxTest::TestSuite
+{
+public:
+    void testAligned() {
+        ArenaBase *a = new ArenaBase, *b = new ArenaDerived;
+        TS_ASSERT_EQUALS( reinterpret_cast<uintptr_t>(a) % alignof(std::max_align_t), 0u );
+        TS_ASSERT_EQUALS( reinterpret_cast<uintptr_t>(b) % alignof(std::max_align_t), 0u );
+        delete a;
+        delete b;
+    }
+    
+    void testReuseThroughBase() {
+        size_t used = arena::bytesInUse();
+        ArenaBase *a = new ArenaDerived;
+        TS_ASSERT_LESS_THAN_EQUALS( used + sizeof(ArenaDerived), arena::bytesInUse() );
+        delete a;   // through base: must free the size of ArenaDerived
+        TS_ASSERT_EQUALS( arena::bytesInUse(), used );
+        ArenaBase *b = new ArenaDerived;
+        TS_ASSERT_EQUALS( a, b );       // last freed slot of this size is reused
+        delete b;
+    }
+};
+
+#endif
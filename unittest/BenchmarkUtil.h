@@ -0,0 +1,72 @@
+/*
+ This file is part of OpenMalaria.
+
+ Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+
+ OpenMalaria is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or (at
+ your option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+// Helpers for micro-benchmarks. These are cxxtest suites named *BenchSuite.h,
+// built into the "benchmark" executable when OM_BENCHMARK_ENABLE is set. They
+// print timings to stdout and are not run by "make test".
+
+#ifndef Hmod_BenchmarkUtil
+#define Hmod_BenchmarkUtil
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+namespace bench {
+    typedef std::chrono::steady_clock Clock;
+
+    /// Seconds elapsed since start
+    inline double secondsSince( Clock::time_point start ){
+        return std::chrono::duration<double>( Clock::now() - start ).count();
+    }
+
+    /// Print a heading for a group of results
+    inline void heading( const std::string& title ){
+        std::cout << std::endl << "--- " << title << " ---" << std::endl;
+    }
+
+    /** Print one result line.
+     *
+     * @param name Name of the case
+     * @param param Description of case parameters (e.g. population size)
+     * @param seconds Total time taken
+     * @param nOps Number of operations performed in that time
+     * @param unit Name of an operation (e.g. "call", "human-step") */
+    inline void report( const std::string& name, const std::string& param,
+            double seconds, double nOps, const std::string& unit ){
+        std::ios::fmtflags flags = std::cout.flags();
+        std::cout << "  " << std::left << std::setw(28) << name
+            << std::setw(20) << param << std::right << std::fixed
+            << std::setprecision(2) << std::setw(12) << (seconds * 1e9 / nOps)
+            << " ns/" << unit << std::endl;
+        std::cout.flags( flags );
+    }
+
+    /// Stop the compiler optimising away a computed value
+    template<typename T>
+    inline void keep( const T& x ){
+        static volatile T sink;
+        sink = x;
+    }
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ This file is part of OpenMalaria.
+
+ Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+
+ OpenMalaria is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or (at
+ your option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#ifndef Hmod_CheckpointBenchSuite
+#define Hmod_CheckpointBenchSuite
+
+#include <cxxtest/TestSuite.h>
+#include "BenchmarkUtil.h"
+#include "Global.h"
+#include "util/checkpoint_containers.h"
+
+#include <gzstream/gzstream.h>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+using namespace OM;
+using namespace OM::util::checkpoint;
+
+/** Checkpoint write and read throughput, per human.
+ *
+ * Humans are stood in for by records of the typical mix of a human's
+ * checkpointed data: some scalars plus a few arrays (e.g. vecDay buffers and
+ * per-species parameters). Files are written with gzip compression (the
+ * default) and uncompressed (--checkpoint-compression none), and arrays with
+ * the bulk vector path and element by element (the old path; same format). */
+class CheckpointBenchSuite : public CxxTest::TestSuite
+{
+public:
+    void testThroughput () {
+        humans.resize( N_HUMANS );
+        for( size_t i = 0; i < N_HUMANS; ++i ){
+            humans[i].init( i );
+        }
+        bench::heading( "checkpoint: write and read, per human" );
+        run( "gzip, bulk", true, true );
+        run( "gzip, per element", true, false );
+        run( "none, bulk", false, true );
+        run( "none, per element", false, false );
+    }
+
+private:
+    struct Record {
+        double d[12];
+        int n[6];
+        vector<double> a1, a2, a3;
+
+        void init( size_t i ){
+            for( int j = 0; j < 12; ++j ) d[j] = i * 0.001 + j;
+            for( int j = 0; j < 6; ++j ) n[j] = i + j;
+            a1.assign( 30, i * 0.5 );
+            a2.assign( 10, i * 0.25 );
+            a3.assign( 5, 1.0 / (i + 1) );
+        }
+
+        template<class S>
+        void scalars( S& stream ){
+            for( int j = 0; j < 12; ++j ) d[j] & stream;
+            for( int j = 0; j < 6; ++j ) n[j] & stream;
+        }
+        void write( ostream& stream, bool bulk ){
+            scalars( stream );
+            if( bulk ){
+                a1 & stream;
+                a2 & stream;
+                a3 & stream;
+            }else{
+                writeElements( a1, stream );
+                writeElements( a2, stream );
+                writeElements( a3, stream );
+            }
+        }
+        void read( istream& stream, bool bulk ){
+            scalars( stream );
+            if( bulk ){
+                a1 & stream;
+                a2 & stream;
+                a3 & stream;
+            }else{
+                readElements( a1, stream );
+                readElements( a2, stream );
+                readElements( a3, stream );
+            }
+        }
+        static void writeElements( vector<double>& x, ostream& stream ){
+            x.size() & stream;
+            for( double& y : x ) y & stream;
+        }
+        static void readElements( vector<double>& x, istream& stream ){
+            size_t l;
+            l & stream;
+            validateListSize( l );
+            x.resize( l );
+            for( double& y : x ) y & stream;
+        }
+    };
+
+    void writeAll( ostream& stream, bool bulk ){
+        header( stream );
+        for( Record& r : humans ) r.write( stream, bulk );
+    }
+    void readAll( istream& stream, bool bulk ){
+        header( stream );
+        for( Record& r : humans ) r.read( stream, bulk );
+    }
+
+    void run( const char* name, bool gzip, bool bulk ){
+        bench::Clock::time_point start = bench::Clock::now();
+        if( gzip ){
+            ogzstream out( FILE_NAME, ios::out | ios::binary );
+            writeAll( out, bulk );
+            out.close();
+        }else{
+            ofstream out( FILE_NAME, ios::out | ios::binary );
+            writeAll( out, bulk );
+            out.close();
+        }
+        double tWrite = bench::secondsSince( start );
+
+        start = bench::Clock::now();
+        if( gzip ){
+            igzstream in( FILE_NAME, ios::in | ios::binary );
+            readAll( in, bulk );
+            in.close();
+        }else{
+            ifstream in( FILE_NAME, ios::in | ios::binary );
+            readAll( in, bulk );
+        }
+        double tRead = bench::secondsSince( start );
+
+        ifstream file( FILE_NAME, ios::in | ios::binary | ios::ate );
+        ostringstream param;
+        param << (file.tellg() / 1024) << " KiB";
+        file.close();
+        std::remove( FILE_NAME );
+
+        bench::report( string(name) + ": write", param.str(), tWrite, N_HUMANS, "human" );
+        bench::report( string(name) + ": read", param.str(), tRead, N_HUMANS, "human" );
+        TS_ASSERT_EQUALS( humans[N_HUMANS - 1].n[0], int(N_HUMANS - 1) );
+    }
+
+    static const size_t N_HUMANS = 100000;
+    static const char* const FILE_NAME;
+
+    vector<Record> humans;
+};
+
+const char* const CheckpointBenchSuite::FILE_NAME = "checkpoint-bench.tmp";
+
+#endif
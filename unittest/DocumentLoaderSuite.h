@@ -0,0 +1,90 @@
+/*
+ This file is part of OpenMalaria.
+ 
+ Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+ 
+ OpenMalaria is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or (at
+ your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef Hmod_DocumentLoaderSuite
+#define Hmod_DocumentLoaderSuite
+
+#include <cxxtest/TestSuite.h>
+#include "UnittestUtil.h"
+#include "util/DocumentLoader.h"
+
+#ifdef OM_SCENARIO_CACHE
+#include <schema/schemaHash.h>
+#include <cstdio>
+
+using namespace OM::util;
+#endif
+
+/** The binary scenario cache (only built with OM_SCENARIO_CACHE). */
+class DocumentLoaderSuite : public CxxTest::TestSuite
+{
+public:
+    void setUp () {
+        UnittestUtil::initTime( 5 );
+    }
+    
+    void testCacheHeader () {
+#ifdef OM_SCENARIO_CACHE
+        const string header = cache::header( "<scenario/>" );
+        TS_ASSERT_DIFFERS( header.find( OM_SCHEMA_HASH ), string::npos );
+        TS_ASSERT_EQUALS( header, cache::header( "<scenario/>" ) );
+        TS_ASSERT_DIFFERS( header, cache::header( "<scenario />" ) );
+        TS_ASSERT_DIFFERS( header, cache::header( "<scenarjo/>" ) );   // same length
+#else
+        TS_SKIP( "built without OM_SCENARIO_CACHE" );
+#endif
+    }
+    
+    // A scenario saved to the cache is loaded back only with the same header
+    void testCacheRoundTrip () {
+#ifdef OM_SCENARIO_CACHE
+        const string file = "DocumentLoaderSuite.xml.cache";
+        const string header = cache::header( "<scenario/>" );
+        cache::save( file, header, dummyXML::scenario );
+        
+        unique_ptr<scnXml::Scenario> loaded = cache::load( file, header );
+        TS_ASSERT( loaded != nullptr );
+        if( loaded != nullptr ){
+            TS_ASSERT_EQUALS( loaded->getName(), dummyXML::scenario.getName() );
+            TS_ASSERT_EQUALS( loaded->getDemography().getMaximumAgeYrs(),
+                dummyXML::scenario.getDemography().getMaximumAgeYrs() );
+            TS_ASSERT_EQUALS( loaded->getModel().getParameters().getInterval(),
+                dummyXML::scenario.getModel().getParameters().getInterval() );
+            TS_ASSERT_EQUALS( loaded->getMonitoring().getSurveys().getSurveyTime().size(),
+                dummyXML::scenario.getMonitoring().getSurveys().getSurveyTime().size() );
+        }
+        
+        // another scenario text, or a header written by a build with other
+        // schema files (here: one character changed), is rejected
+        TS_ASSERT( cache::load( file, cache::header( "<scenario />" ) ) == nullptr );
+        string other = header;
+        other[other.find( OM_SCHEMA_HASH )] ^= 1;
+        TS_ASSERT( cache::load( file, other ) == nullptr );
+        TS_ASSERT( cache::load( file + ".missing", header ) == nullptr );
+        std::remove( file.c_str() );
+#else
+        TS_SKIP( "built without OM_SCENARIO_CACHE" );
+#endif
+    }
+};
+
+#endif
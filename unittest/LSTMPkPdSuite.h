@@ -25,6 +25,7 @@
 
 #include <cxxtest/TestSuite.h>
 #include "PkPd/LSTMModel.h"
+#include "PkPd/Drug/LSTMIntegration.h"
 #include "WithinHost/Infection/DummyInfection.h"
 #include "UnittestUtil.h"
 #include "ExtraAsserts.h"
@@ -54,6 +55,7 @@ public:
         MQ_index = LSTMDrugType::findDrug( "MQ" );
     }
     void tearDown () {
+        LSTMIntegration::setMethod( LSTMIntegration::QAG );
         delete inf;
 	delete proxy;
         LSTMDrugType::clear();
@@ -93,7 +95,57 @@ public:
 	TS_ASSERT_APPROX (proxy->getDrugFactor (m_rng, inf, massAt21), 0.03174563637686205);
     }
     
+    // Factors are memorised per drug until doses or concentrations change;
+    // results must be as if calculated afresh. The first dose is small (well
+    // below IC50), so a stale factor would be far from the expected values.
+    void testFactorCacheInvalidated () {
+	UnittestUtil::medicate( m_rng, *proxy, MQ_index, 10, 0 );
+	TS_ASSERT_LESS_THAN (0.5, proxy->getDrugFactor (m_rng, inf, massAt21));
+	TS_ASSERT_EQUALS (UnittestUtil::numCachedDrugFactors( *proxy ), 1u);
+	UnittestUtil::medicate( m_rng, *proxy, MQ_index, 2990, 0 );
+	TS_ASSERT_EQUALS (UnittestUtil::numCachedDrugFactors( *proxy ), 0u);
+	TS_ASSERT_APPROX (proxy->getDrugFactor (m_rng, inf, massAt21), 0.03174563638523168);
+	TS_ASSERT_EQUALS (UnittestUtil::numCachedDrugFactors( *proxy ), 1u);
+	// same infection: found in the cache
+	TS_ASSERT_APPROX (proxy->getDrugFactor (m_rng, inf, massAt21), 0.03174563638523168);
+	TS_ASSERT_EQUALS (UnittestUtil::numCachedDrugFactors( *proxy ), 1u);
+	proxy->decayDrugs (massAt21);
+	TS_ASSERT_EQUALS (UnittestUtil::numCachedDrugFactors( *proxy ), 0u);
+	TS_ASSERT_APPROX (proxy->getDrugFactor (m_rng, inf, massAt21), 0.03174563639501896);
+    }
+    
+    // Gauss-Legendre integration must agree with QAG to within the integration
+    // tolerance (rel_eps = 1e-2 on the integral, thus also on the factor).
+    void testGaussLegendreThreeComp () {
+        vector<double> qag = dailyFactors( "PPQ3", 900, LSTMIntegration::QAG );
+        vector<double> gl = dailyFactors( "PPQ3", 900, LSTMIntegration::GAUSS_LEGENDRE );
+        TS_ASSERT_VECTOR_APPROX_TOL( gl, qag, 1e-2, 1e-12 );
+    }
+    
+    void testGaussLegendreConversion () {
+        vector<double> qag = dailyFactors( "AR", 80, LSTMIntegration::QAG );
+        vector<double> gl = dailyFactors( "AR", 80, LSTMIntegration::GAUSS_LEGENDRE );
+        TS_ASSERT_VECTOR_APPROX_TOL( gl, qag, 1e-2, 1e-12 );
+    }
+    
 private:
+    // Factors for six days with a dose at a quarter-day on days 0-2, using
+    // the given integration method.
+    vector<double> dailyFactors( const char* drug, double qty, LSTMIntegration::Method method ){
+        LSTMIntegration::setMethod( method );
+        m_rng.seed(0, 721347520444481703);
+        LSTMModel model;
+        size_t index = LSTMDrugType::findDrug( drug );
+        vector<double> factors;
+        for( int day = 0; day < 6; ++day ){
+            if( day < 3 ) UnittestUtil::medicate( m_rng, model, index, qty, 0.25 );
+            factors.push_back( model.getDrugFactor( m_rng, inf, massAt21 ) );
+            UnittestUtil::incrTime( SimTime::oneDay() );
+            model.decayDrugs( massAt21 );
+        }
+        return factors;
+    }
+    
     LocalRng m_rng;
     LSTMModel *proxy;
     CommonInfection *inf;
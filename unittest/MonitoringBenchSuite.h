@@ -0,0 +1,127 @@
+/*
+ This file is part of OpenMalaria.
+
+ Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+
+ OpenMalaria is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or (at
+ your option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#ifndef Hmod_MonitoringBenchSuite
+#define Hmod_MonitoringBenchSuite
+
+#include <cxxtest/TestSuite.h>
+#include "UnittestUtil.h"
+#include "BenchmarkUtil.h"
+#include "mon/reporting.h"
+#include "mon/management.h"
+#include "mon/info.h"
+#include "util/parallel.h"
+
+#include <sstream>
+
+/** Cost of monitoring report calls, per human per time step.
+ *
+ * Each simulated human makes one integer (event) and one floating-point
+ * report per step, like a typical Human::update; each step concludes a
+ * survey so that reduction of per-thread results is included. */
+class MonitoringBenchSuite : public CxxTest::TestSuite
+{
+public:
+    MonitoringBenchSuite () {
+        UnittestUtil::initTime(5);
+        // initTime adds survey "1t"; one more survey per benchmarked step:
+        for( int i = 2; i <= N_SURVEYS; ++i ){
+            std::ostringstream t;
+            t << i << 't';
+            dummyXML::surveys.getSurveyTime().push_back( scnXml::SurveyTime( t.str() ) );
+        }
+        dummyXML::monitoring.setSurveys( dummyXML::surveys );
+
+        dummyXML::survOpts.getOption().push_back( scnXml::MonitoringOption( "nUncomp" ) );
+        dummyXML::survOpts.getOption().push_back( scnXml::MonitoringOption( "innoculationsPerAgeGroup" ) );
+        dummyXML::monitoring.setSurveyOptions( dummyXML::survOpts );
+        const double ageBounds[] = { 1, 2, 5, 10, 15, 20, 30, 40, 50, 60, 90 };
+        foreach( double ub, ageBounds ){
+            dummyXML::monAgeGroup.getGroup().push_back( scnXml::MonGroupBounds( ub ) );
+        }
+        dummyXML::monitoring.setAgeGroup( dummyXML::monAgeGroup );
+        dummyXML::scenario.setMonitoring( dummyXML::monitoring );
+
+        // shards are sized by the number of threads at initMainSim
+        util::parallel::setNumThreads( MAX_THREADS );
+        mon::readSurveyDates( dummyXML::monitoring );
+        mon::initReporting( dummyXML::scenario );
+        mon::initMainSim();
+
+        ageGroups.resize( N_HUMANS );
+        for( size_t i = 0; i < N_HUMANS; ++i ){
+            ageGroups[i].update( SimTime::fromYearsD( (i % 900) / 10.0 ) );
+        }
+    }
+
+    void tearDown () {
+        util::parallel::setNumThreads( 1 );
+    }
+
+    void testReportCost () {
+        bench::heading( "mon: two report calls per human per step" );
+        run( "serial", 0 );
+        for( size_t nThreads = 1; nThreads <= MAX_THREADS; nThreads *= 2 ){
+            run( "forChunks", nThreads );
+        }
+    }
+
+private:
+    // Report for humans [begin, end)
+    void reportRange( size_t begin, size_t end ){
+        const size_t survey = mon::eventSurveyNumber();
+        for( size_t i = begin; i < end; ++i ){
+            mon::reportMSACI( mon::MHE_UNCOMPLICATED_EPISODES, survey,
+                    ageGroups[i], 0, 1 );
+            mon::reportStatMACGF( mon::MVF_INOCS, ageGroups[i].i(), 0, 0,
+                    0.01 * (i % 7) );
+        }
+    }
+
+    // Run STEPS steps; nThreads == 0 means call directly (no forChunks)
+    void run( const char* name, size_t nThreads ){
+        if( nThreads > 0 ) util::parallel::setNumThreads( nThreads );
+        bench::Clock::time_point start = bench::Clock::now();
+        for( int step = 0; step < STEPS; ++step ){
+            if( nThreads == 0 ){
+                reportRange( 0, N_HUMANS );
+            }else{
+                util::parallel::forChunks( N_HUMANS,
+                    [this]( size_t begin, size_t end ){ reportRange( begin, end ); } );
+            }
+            mon::concludeSurvey();
+        }
+        double t = bench::secondsSince( start );
+        std::ostringstream param;
+        param << nThreads << " threads";
+        bench::report( name, param.str(), t, double(STEPS) * N_HUMANS, "human-step" );
+    }
+
+    static const size_t N_HUMANS = 100000;
+    static const size_t MAX_THREADS = 4;
+    static const int STEPS = 20;
+    // serial run plus one per thread count 1, 2, ..., MAX_THREADS
+    static const int N_SURVEYS = 4 * STEPS;
+
+    vector<mon::AgeGroup> ageGroups;
+};
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ This file is part of OpenMalaria.
+
+ Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+ Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+
+ OpenMalaria is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or (at
+ your option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#ifndef Hmod_PopulationBenchSuite
+#define Hmod_PopulationBenchSuite
+
+#include <cxxtest/TestSuite.h>
+#include "UnittestUtil.h"
+#include "BenchmarkUtil.h"
+#include "Population.h"
+#include "PopulationAgeStructure.h"
+
+#include <sstream>
+
+using namespace OM;
+
+/** Cost of removing dead and out-migrating humans from the population and
+ * adding new-borns, per time step, against population size.
+ *
+ * Humans are not updated (only removal matters here), so humans are made
+ * with the test constructor and flagged for removal at the maximum age. The
+ * old erase-per-removal loop is included for comparison. */
+class PopulationBenchSuite : public CxxTest::TestSuite
+{
+public:
+    void testRemovalCost () {
+        init();
+        bench::heading( "Population: removal and births per step" );
+        for( size_t n = 10000; n <= 1000000; n *= 10 ){
+            run( "compaction", n, false );
+            run( "erase (old)", n, true );
+        }
+    }
+
+private:
+    void init(){
+        UnittestUtil::initTime( 5 );
+        UnittestUtil::initAgeStructure();
+    }
+
+    // Make a population of n with the target age structure (as Population::createInitialHumans)
+    void createHumans( Population::HumanPop& pop, size_t n ){
+        pop.clear();
+        pop.reserve( n );
+        int cumPop = 0;
+        for( size_t iage_prev = AgeStructure::getMaxTStepsPerLife(), iage = iage_prev - 1;
+            iage_prev > 0; iage_prev = iage, iage -= 1 )
+        {
+            int target = AgeStructure::targetCumPop( iage, n );
+            for( ; cumPop < target; ++cumPop ){
+                pop.push_back( std::move( *UnittestUtil::createHuman( sim::ts1() - SimTime::fromTS(iage) ) ) );
+            }
+        }
+    }
+
+    // As removeHumans, but erasing humans one at a time (the old method)
+    static int eraseHumans( Population::HumanPop& pop, int targetPop ){
+        int cumPop = 0;
+        for( Population::Iter iter = pop.begin(); iter != pop.end(); ){
+            bool outmigrate = cumPop >= AgeStructure::targetCumPop(
+                iter->age(sim::ts1()).inSteps(), targetPop );
+            if( iter->remove() || outmigrate ){
+                iter = pop.erase( iter );
+                continue;
+            }
+            ++cumPop;
+            ++iter;
+        }
+        return cumPop;
+    }
+
+    void run( const char* name, size_t n, bool erase ){
+        Population::HumanPop pop;
+        createHumans( pop, n );
+        double t = 0.0;
+        for( int step = 0; step < STEPS; ++step ){
+            UnittestUtil::incrTime( SimTime::oneTS() );
+            // humans reaching the maximum age die (as Human::update)
+            for( size_t i = 0; i < pop.size() &&
+                pop[i].age(sim::ts0()) >= sim::maxHumanAge(); ++i )
+            {
+                UnittestUtil::setHumanRemove( pop[i] );
+            }
+
+            bench::Clock::time_point start = bench::Clock::now();
+            int cumPop = erase ? eraseHumans( pop, n ) :
+                Population::removeHumans( pop, n );
+            for( ; cumPop < static_cast<int>(n); ++cumPop ){
+                pop.push_back( std::move( *UnittestUtil::createHuman( sim::ts1() ) ) );
+            }
+            t += bench::secondsSince( start );
+        }
+        TS_ASSERT_EQUALS( pop.size(), n );
+        std::ostringstream param;
+        param << n << " humans";
+        bench::report( name, param.str(), t, STEPS, "step" );
+    }
+
+    static const int STEPS = 10;
+};
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ This file is part of OpenMalaria.
+
+ Copyright (C) 2005-2014 Swiss Tropical and Public Health Institute
+ Copyright (C) 2005-2014 Liverpool School Of Tropical Medicine
+
+ OpenMalaria is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or (at
+ your option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef Hmod_PopulationSuite
+#define Hmod_PopulationSuite
+
+#include <cxxtest/TestSuite.h>
+#include "UnittestUtil.h"
+#include "Population.h"
+#include "SimContext.h"
+
+using OM::interventions::ComponentId;
+
+/** Selection of humans from the population: ageRange() and the
+ * sub-population candidate lists kept across removal of humans. */
+class PopulationSuite : public CxxTest::TestSuite
+{
+public:
+    void setUp () {
+        UnittestUtil::initTime( 5 );
+        Population& pop = UnittestUtil::testPopulation();
+        pop.population.clear();
+        pop.subPopIndex.clear();
+        // ages 20, 19, ..., 1, 0 years (oldest first, as the population)
+        for( int i = 0; i < N; ++i ){
+            pop.population.push_back( std::move( *UnittestUtil::createHuman(
+                sim::now() - SimTime::fromYearsI( N - 1 - i ) ) ) );
+        }
+        pop.populationSize = N;
+    }
+    void tearDown () {
+        Population& pop = UnittestUtil::testPopulation();
+        pop.population.clear();
+        pop.subPopIndex.clear();
+        pop.populationSize = 0;
+    }
+
+    void testAgeRange () {
+        Population& pop = UnittestUtil::testPopulation();
+        // minAge is inclusive, maxAge exclusive
+        checkAgeRange( pop, SimTime::fromYearsI( 5 ), SimTime::fromYearsI( 10 ), 5, 10 );
+        checkAgeRange( pop, SimTime::zero(), SimTime::fromYearsI( 1 ), 0, 1 );
+        checkAgeRange( pop, SimTime::zero(), SimTime::future(), 0, N );
+        checkAgeRange( pop, SimTime::fromYearsI( 15 ), SimTime::future(), 15, N );
+        checkAgeRange( pop, SimTime::fromYearsI( N - 1 ), SimTime::future(), N - 1, N );
+        // ages between those of humans
+        checkAgeRange( pop, SimTime::fromDays( 3 * 365 + 1 ), SimTime::fromDays( 7 * 365 - 1 ), 4, 7 );
+        // empty ranges
+        checkAgeRange( pop, SimTime::fromYearsI( 8 ), SimTime::fromYearsI( 8 ), 8, 8 );
+        checkAgeRange( pop, SimTime::fromYearsI( N ), SimTime::future(), N, N );
+
+        // an empty population
+        pop.population.clear();
+        std::pair<Population::Iter, Population::Iter> range =
+            pop.ageRange( SimTime::zero(), SimTime::future() );
+        TS_ASSERT( range.first == pop.population.end() );
+        TS_ASSERT( range.second == pop.population.end() );
+    }
+
+    // Candidate lists must stay correct when humans are removed (indices are
+    // remapped, not rebuilt) and when humans join afterwards
+    void testSubPopRemap () {
+        Population& pop = UnittestUtil::testPopulation();
+        UnittestUtil::initAgeStructure();
+        const ComponentId id( 3 );
+
+        // every third human joins for a year, every fifth for one step
+        for( int i = 0; i < N; ++i ){
+            if( i % 3 == 0 ) pop.population[i].reportDeployment( id, SimTime::fromYearsI( 1 ) );
+            else if( i % 5 == 0 ) pop.population[i].reportDeployment( id, SimTime::oneTS() );
+        }
+        UnittestUtil::incrTime( SimTime::oneTS() );
+        checkCandidates( pop, id );
+
+        // remove every fourth human
+        for( int i = 0; i < N; i += 4 ){
+            UnittestUtil::setHumanRemove( pop.population[i] );
+        }
+        // a large target: only the flagged humans are removed
+        int cumPop = Population::removeHumans( pop.population, 1000 * N, &pop.newIndexBuffer );
+        pop.remapSubPopIndex( pop.newIndexBuffer );
+        TS_ASSERT_EQUALS( cumPop, N - (N + 3) / 4 );
+        TS_ASSERT_EQUALS( pop.population.size(), static_cast<size_t>(cumPop) );
+        // no human joined, so the remapped list is used as it is
+        TS_ASSERT_EQUALS( pop.subPopIndex[id].joins, SimContext::current().subPopJoinCount( id.id ) );
+        checkCandidates( pop, id );
+
+        // redeploy to existing members only: the list is still used
+        for( size_t i = 0; i < pop.population.size(); ++i ){
+            if( pop.population[i].isInSubPop( id ) )
+                pop.population[i].reportDeployment( id, SimTime::fromYearsI( 1 ) );
+        }
+        TS_ASSERT_EQUALS( pop.subPopIndex[id].joins, SimContext::current().subPopJoinCount( id.id ) );
+        checkCandidates( pop, id );
+
+        // redeploy to every second human: some join, so the list is rebuilt
+        for( size_t i = 0; i < pop.population.size(); i += 2 ){
+            pop.population[i].reportDeployment( id, SimTime::fromYearsI( 1 ) );
+        }
+        TS_ASSERT_DIFFERS( pop.subPopIndex[id].joins, SimContext::current().subPopJoinCount( id.id ) );
+        checkCandidates( pop, id );
+    }
+
+private:
+    // Check ageRange( minAge, maxAge ) gives humans first to last (indices)
+    void checkAgeRange( Population& pop, SimTime minAge, SimTime maxAge, int first, int last ){
+        std::pair<Population::Iter, Population::Iter> range = pop.ageRange( minAge, maxAge );
+        // humans are ordered oldest first, so the youngest has index N - 1
+        TS_ASSERT_EQUALS( range.first - pop.population.begin(), N - last );
+        TS_ASSERT_EQUALS( range.second - pop.population.begin(), N - first );
+    }
+
+    // Compare subPopCandidates( id ) against a scan of the whole population
+    void checkCandidates( Population& pop, ComponentId id ){
+        vector<size_t> records, members, selected;
+        for( size_t i = 0; i < pop.population.size(); ++i ){
+            if( pop.population[i].hasSubPopRecord( id ) ) records.push_back( i );
+            if( pop.population[i].isInSubPop( id ) ) members.push_back( i );
+        }
+        const vector<size_t>& candidates = pop.subPopCandidates( id );
+        for( size_t i : candidates ){
+            TS_ASSERT_LESS_THAN( i, pop.population.size() );
+            if( pop.population[i].isInSubPop( id ) ) selected.push_back( i );
+        }
+        TS_ASSERT( candidates == records );
+        TS_ASSERT( selected == members );
+        TS_ASSERT( !members.empty() );
+    }
+
+    static const int N = 21;
+};
+
+#endif
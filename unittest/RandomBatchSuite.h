@@ -0,0 +1,81 @@
+/*
+ This file is part of OpenMalaria.
+ 
+ Copyright (C) 2005-2014 Swiss Tropical and Public Health Institute
+ Copyright (C) 2005-2014 Liverpool School Of Tropical Medicine
+ 
+ OpenMalaria is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or (at
+ your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef Hmod_RandomBatchSuite
+#define Hmod_RandomBatchSuite
+
+#include <cxxtest/TestSuite.h>
+#include "util/random.h"
+#include <memory>
+#include <vector>
+
+using namespace OM::util;
+
+/** Batched sampling must give exactly the numbers of one-at-a-time sampling. */
+class RandomBatchSuite : public CxxTest::TestSuite
+{
+public:
+    void testFillUniform01 () {
+        // lengths around the 4-lane kernel's boundaries
+        const size_t lengths[] = { 0, 1, 3, 7, 8, 9, 100, 1003 };
+        for( size_t n : lengths ){
+            LocalRng a( 12345, 678 ), b( 12345, 678 );
+            std::vector<double> x( n );
+            a.fill_uniform_01( x.data(), n );
+            for( size_t i = 0; i < n; ++i )
+                TS_ASSERT_EQUALS( x[i], b.uniform_01() );
+            // and the state afterwards:
+            TS_ASSERT_EQUALS( a.uniform_01(), b.uniform_01() );
+        }
+    }
+    
+    void testFillGauss () {
+        LocalRng a( 5, 6 ), b( 5, 6 );
+        double x[10];
+        a.fill_gauss( x, 10, 2.0, 0.5 );
+        for( size_t i = 0; i < 10; ++i )
+            TS_ASSERT_EQUALS( x[i], b.gauss( 2.0, 0.5 ) );
+    }
+    
+    void testEach () {
+        const size_t N = 11;    // one draw from each of N independent engines
+        std::vector<std::unique_ptr<LocalRng>> a, b;
+        std::vector<LocalRng*> ptrs;
+        for( size_t i = 0; i < N; ++i ){
+            a.emplace_back( new LocalRng( i * 7 + 1, i ) );
+            b.emplace_back( new LocalRng( i * 7 + 1, i ) );
+            ptrs.push_back( a.back().get() );
+        }
+        for( int round = 0; round < 3; ++round ){
+            double u[N];
+            LocalRng::uniform_01_each( ptrs.data(), u, N );
+            for( size_t i = 0; i < N; ++i )
+                TS_ASSERT_EQUALS( u[i], b[i]->uniform_01() );
+        }
+        bool comply[N];
+        LocalRng::bernoulli_each( ptrs.data(), 0.3, comply, N );
+        for( size_t i = 0; i < N; ++i )
+            TS_ASSERT_EQUALS( comply[i], b[i]->bernoulli( 0.3 ) );
+    }
+};
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ This file is part of OpenMalaria.
+ 
+ Copyright (C) 2005-2014 Swiss Tropical and Public Health Institute
+ Copyright (C) 2005-2014 Liverpool School Of Tropical Medicine
+ 
+ OpenMalaria is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or (at
+ your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef Hmod_RandomBenchSuite
+#define Hmod_RandomBenchSuite
+
+#include <cxxtest/TestSuite.h>
+#include "BenchmarkUtil.h"
+#include "util/random.h"
+#include "util/samplers.h"
+#include <gsl/gsl_randist.h>
+#include <memory>
+#include <vector>
+
+using namespace OM::util;
+
+/** Uniform [0,1) sampling from LocalRng, one at a time and batched: from one
+ * RNG (fill_uniform_01) and one draw from each of many RNGs, as when
+ * deploying to each human (uniform_01_each).
+ * 
+ * Also distribution sampling through GSL (the default build) against the
+ * inline samplers of util/samplers.h (OM_RANDOM_INLINE_DIST). */
+class RandomBenchSuite : public CxxTest::TestSuite
+{
+public:
+    void testUniform01 () {
+        bench::heading( "random: uniform_01 per sample" );
+        std::vector<double> x( N );
+        {
+            LocalRng rng( 1, 2 );
+            bench::Clock::time_point start = bench::Clock::now();
+            for( int r = 0; r < ROUNDS; ++r )
+                for( size_t i = 0; i < N; ++i ) x[i] = rng.uniform_01();
+            bench::keep( x[N - 1] );
+            bench::report( "one RNG, sequential", "", bench::secondsSince( start ), double(ROUNDS) * N, "sample" );
+        }
+        {
+            LocalRng rng( 1, 2 );
+            bench::Clock::time_point start = bench::Clock::now();
+            for( int r = 0; r < ROUNDS; ++r )
+                rng.fill_uniform_01( x.data(), N );
+            bench::keep( x[N - 1] );
+            bench::report( "one RNG, fill_uniform_01", "", bench::secondsSince( start ), double(ROUNDS) * N, "sample" );
+        }
+        
+        std::vector<std::unique_ptr<LocalRng>> rngs;
+        std::vector<LocalRng*> ptrs;
+        for( size_t i = 0; i < N; ++i ){
+            rngs.emplace_back( new LocalRng( i, i + 1 ) );
+            ptrs.push_back( rngs.back().get() );
+        }
+        {
+            bench::Clock::time_point start = bench::Clock::now();
+            for( int r = 0; r < ROUNDS; ++r )
+                for( size_t i = 0; i < N; ++i ) x[i] = ptrs[i]->uniform_01();
+            bench::keep( x[N - 1] );
+            bench::report( "many RNGs, sequential", "", bench::secondsSince( start ), double(ROUNDS) * N, "sample" );
+        }
+        {
+            bench::Clock::time_point start = bench::Clock::now();
+            for( int r = 0; r < ROUNDS; ++r )
+                LocalRng::uniform_01_each( ptrs.data(), x.data(), N );
+            bench::keep( x[N - 1] );
+            bench::report( "many RNGs, uniform_01_each", "", bench::secondsSince( start ), double(ROUNDS) * N, "sample" );
+        }
+    }
+    
+    void testDistributions () {
+        bench::heading( "random: distributions per sample, GSL and inline" );
+        compare( "gauss", "",
+                []( gsl_rng* g ){ return gsl_ran_gaussian( g, 1.0 ); },
+                []( pcg32& e ){ return samplers::gauss( e ); } );
+        compare( "gamma", "shape 0.5",
+                []( gsl_rng* g ){ return gsl_ran_gamma( g, 0.5, 2.0 ); },
+                []( pcg32& e ){ return samplers::gamma( e, 0.5, 2.0 ); } );
+        compare( "gamma", "shape 5",
+                []( gsl_rng* g ){ return gsl_ran_gamma( g, 5.0, 2.0 ); },
+                []( pcg32& e ){ return samplers::gamma( e, 5.0, 2.0 ); } );
+        compare( "log_normal", "",
+                []( gsl_rng* g ){ return gsl_ran_lognormal( g, 0.0, 0.5 ); },
+                []( pcg32& e ){ return samplers::log_normal( e, 0.0, 0.5 ); } );
+        compare( "beta", "",
+                []( gsl_rng* g ){ return gsl_ran_beta( g, 2.0, 5.0 ); },
+                []( pcg32& e ){ return samplers::beta( e, 2.0, 5.0 ); } );
+        compare( "poisson", "lambda 3",
+                []( gsl_rng* g ){ return double( gsl_ran_poisson( g, 3.0 ) ); },
+                []( pcg32& e ){ return double( samplers::poisson( e, 3.0 ) ); } );
+        compare( "poisson", "lambda 100",
+                []( gsl_rng* g ){ return double( gsl_ran_poisson( g, 100.0 ) ); },
+                []( pcg32& e ){ return double( samplers::poisson( e, 100.0 ) ); } );
+    }
+
+private:
+    // Time the GSL sampler, then the inline one, over a pcg32 engine
+    template<class G, class I>
+    void compare( const std::string& name, const std::string& param, G gsl, I inl ){
+        std::vector<double> x( N );
+        pcg32 engine( 1, 2 );
+        gsl_rng_type type = make_gsl_rng_type( engine );
+        gsl_rng gen;
+        gen.type = &type;
+        gen.state = reinterpret_cast<void*>( &engine );
+        
+        bench::Clock::time_point start = bench::Clock::now();
+        for( int r = 0; r < DIST_ROUNDS; ++r )
+            for( size_t i = 0; i < N; ++i ) x[i] = gsl( &gen );
+        bench::keep( x[N - 1] );
+        bench::report( name + ", GSL", param, bench::secondsSince( start ), double(DIST_ROUNDS) * N, "sample" );
+        
+        start = bench::Clock::now();
+        for( int r = 0; r < DIST_ROUNDS; ++r )
+            for( size_t i = 0; i < N; ++i ) x[i] = inl( engine );
+        bench::keep( x[N - 1] );
+        bench::report( name + ", inline", param, bench::secondsSince( start ), double(DIST_ROUNDS) * N, "sample" );
+    }
+    
+    static const size_t N = 100000;
+    static const int ROUNDS = 100;
+    static const int DIST_ROUNDS = 20;
+};
+
+#endif
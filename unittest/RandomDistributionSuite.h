@@ -0,0 +1,158 @@
+/*
+ This file is part of OpenMalaria.
+ 
+ Copyright (C) 2005-2014 Swiss Tropical and Public Health Institute
+ Copyright (C) 2005-2014 Liverpool School Of Tropical Medicine
+ 
+ OpenMalaria is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or (at
+ your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef Hmod_RandomDistributionSuite
+#define Hmod_RandomDistributionSuite
+
+#include <cxxtest/TestSuite.h>
+#include "util/random.h"
+#include "util/samplers.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <cmath>
+
+using namespace OM::util;
+
+/** Accuracy of the inline samplers (util/samplers.h).
+ *
+ * These are tested directly, whichever sampling path util::RNG is built
+ * with. Sample moments are compared against the exact ones, allowing five
+ * standard errors; seeds are fixed so results are repeatable. */
+class RandomDistributionSuite : public CxxTest::TestSuite
+{
+public:
+    void testGaussMoments () {
+        checkMoments( [](pcg32& e){ return samplers::gauss( e ); }, 0.0, 1.0, 3.0 );
+    }
+    
+    void testGaussKS () {
+        // Kolmogorov-Smirnov statistic against the normal CDF; this also
+        // covers the ziggurat's wedges and tail
+        pcg32 engine( 3, 4 );
+        const size_t n = 100000;
+        std::vector<double> x( n );
+        for( double& y : x ) y = samplers::gauss( engine );
+        std::sort( x.begin(), x.end() );
+        double d = 0.0;
+        for( size_t i = 0; i < n; ++i ){
+            double cdf = 0.5 * std::erfc( -x[i] / std::sqrt( 2.0 ) );
+            d = std::max( d, std::max( cdf - double(i) / n, double(i + 1) / n - cdf ) );
+        }
+        TS_ASSERT_LESS_THAN( d, 1.63 / std::sqrt( double(n) ) );     // 1% level
+        // the tail beyond the ziggurat's base layer must be reached
+        TS_ASSERT_LESS_THAN( x[0], -3.5 );
+        TS_ASSERT_LESS_THAN( 3.5, x[n - 1] );
+    }
+    
+    void testGamma () {
+        // shape < 1 uses the boosted path
+        const double shapes[] = { 0.3, 1.0, 2.5, 40.0 };
+        for( double a : shapes ){
+            const double b = 1.7;
+            checkMoments( [a, b](pcg32& e){ return samplers::gamma( e, a, b ); },
+                    a * b, a * b * b, 3.0 + 6.0 / a );
+        }
+    }
+    
+    void testLogNormal () {
+        const double mu = 0.4, sigma = 0.5;
+        const double s2 = sigma * sigma;
+        checkMoments( [mu, sigma](pcg32& e){ return samplers::log_normal( e, mu, sigma ); },
+                std::exp( mu + s2 / 2 ), (std::exp( s2 ) - 1) * std::exp( 2 * mu + s2 ),
+                std::exp( 4 * s2 ) + 2 * std::exp( 3 * s2 ) + 3 * std::exp( 2 * s2 ) - 3 );
+    }
+    
+    void testBeta () {
+        const double a = 2.0, b = 5.0;
+        checkMoments( [a, b](pcg32& e){ return samplers::beta( e, a, b ); },
+                a / (a + b), a * b / ((a + b) * (a + b) * (a + b + 1)),
+                3.0 + 6 * ((a - b) * (a - b) * (a + b + 1) - a * b * (a + b + 2))
+                / (a * b * (a + b + 2) * (a + b + 3)) );
+    }
+    
+    void testWeibull () {
+        const double lambda = 2.0, k = 1.5;
+        const double g1 = std::tgamma( 1 + 1 / k ), g2 = std::tgamma( 1 + 2 / k ),
+            g3 = std::tgamma( 1 + 3 / k ), g4 = std::tgamma( 1 + 4 / k );
+        const double var = g2 - g1 * g1;
+        const double kurtosis = (g4 - 4 * g1 * g3 + 6 * g1 * g1 * g2
+                - 3 * g1 * g1 * g1 * g1) / (var * var);     // about 4.39
+        checkMoments( [lambda, k](pcg32& e){ return samplers::weibull( e, lambda, k ); },
+                lambda * g1, lambda * lambda * var, kurtosis );
+    }
+    
+    void testPoisson () {
+        // below and above the switch to PTRS at 10
+        const double lambdas[] = { 0.05, 3.0, 9.9, 10.0, 45.0, 2000.0 };
+        for( double lambda : lambdas ){
+            checkMoments( [lambda](pcg32& e){ return double( samplers::poisson( e, lambda ) ); },
+                    lambda, lambda, 3.0 + 1.0 / lambda );
+        }
+        pcg32 engine( 8, 9 );
+        TS_ASSERT_EQUALS( samplers::poisson( engine, 0.0 ), 0 );
+    }
+    
+    void testPoissonPmf () {
+        // PTRS is a rejection method with an approximate hat; check the
+        // frequencies of individual values, not only the moments
+        const double lambda = 12.0;
+        const int n = 400000;
+        pcg32 engine( 10, 11 );
+        std::vector<int> count( 64, 0 );
+        for( int i = 0; i < n; ++i ){
+            int k = samplers::poisson( engine, lambda );
+            TS_ASSERT( k >= 0 );
+            if( k < 64 ) ++count[k];
+        }
+        for( int k = 2; k <= 25; ++k ){
+            double p = std::exp( k * std::log( lambda ) - lambda - std::lgamma( k + 1.0 ) );
+            double se = std::sqrt( n * p * (1 - p) );
+            TS_ASSERT_DELTA( count[k], n * p, 5 * se );
+        }
+    }
+    
+private:
+    /** Sample N values, then check the mean and variance.
+     *
+     * @param kurt Kurtosis of the distribution, giving the standard error of
+     *  the sample variance */
+    void checkMoments( std::function<double(pcg32&)> sample,
+            double mean, double var, double kurt ){
+        pcg32 engine( 1234, 5 );
+        double sum = 0.0, sum2 = 0.0;
+        for( int i = 0; i < N; ++i ){
+            double x = sample( engine );
+            sum += x;
+            sum2 += x * x;
+        }
+        double m = sum / N;
+        double v = sum2 / N - m * m;
+        TS_ASSERT_DELTA( m, mean, 5 * std::sqrt( var / N ) );
+        // var(sample variance) ~ (kurtosis - 1) var^2 / N
+        TS_ASSERT_DELTA( v, var, 5 * var * std::sqrt( (kurt - 1) / N ) );
+    }
+    
+    static const int N = 400000;
+};
+
+#endif
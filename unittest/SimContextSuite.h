@@ -0,0 +1,170 @@
+/*
+ This file is part of OpenMalaria.
+ 
+ Copyright (C) 2005-2014 Swiss Tropical and Public Health Institute
+ Copyright (C) 2005-2014 Liverpool School Of Tropical Medicine
+ 
+ OpenMalaria is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or (at
+ your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef Hmod_SimContextSuite
+#define Hmod_SimContextSuite
+
+#include <cxxtest/TestSuite.h>
+#include "UnittestUtil.h"
+#include "SimContext.h"
+#include "mon/reporting.h"
+#include "mon/management.h"
+#include "mon/info.h"
+#include "util/parallel.h"
+
+#include <sstream>
+
+using namespace OM;
+
+class SimContextSuite : public CxxTest::TestSuite
+{
+public:
+    void setUp () {
+        UnittestUtil::initTime(1);
+    }
+    void tearDown () {
+        restoreMonitoring();
+    }
+    
+    void testIndependentClocks () {
+        int t = sim::ts0().inDays();
+        SimContext other;
+        {
+            SimContext::Bind bind( other );
+            TS_ASSERT_EQUALS( sim::nowOrTs0().inDays(), 0 );
+            UnittestUtil::incrTime( SimTime::fromDays(10) );
+            TS_ASSERT_EQUALS( sim::nowOrTs0().inDays(), 10 );
+        }
+        TS_ASSERT_EQUALS( sim::ts0().inDays(), t );
+    }
+    
+    // Two simulations stepped alternately each report only what they were
+    // given: their output equals that of a simulation run on its own.
+    void testIndependentMonitoring () {
+        initMonitoring();
+        SimContext a, b, alone;
+        for( SimContext *ctx : { &a, &b, &alone } ){
+            SimContext::Bind bind( *ctx );
+            mon::initMainSim();
+        }
+        for( int survey = 0; survey < 2; ++survey ){
+            {
+                SimContext::Bind bind( a );
+                report( survey, 1 );
+            }
+            {
+                SimContext::Bind bind( b );
+                report( survey, 100 );
+            }
+        }
+        {
+            SimContext::Bind bind( alone );
+            report( 0, 1 );
+            report( 1, 1 );
+        }
+        string outA = output( a ), outB = output( b ), outAlone = output( alone );
+        TS_ASSERT_EQUALS( outA, outAlone );
+        TS_ASSERT_DIFFERS( outA, outB );
+        TS_ASSERT_DIFFERS( outB.find( "\t300\n" ), string::npos );    // 3 * 100, not 301
+    }
+    
+    void testWorkersUseCallersContext () {
+        SimContext other;
+        SimContext::Bind bind( other );
+        util::parallel::setNumThreads( 3 );
+        vector<SimContext*> seen( 3, nullptr );
+        util::parallel::forChunks( seen.size(), [&seen]( size_t begin, size_t end ){
+            for( size_t i = begin; i < end; ++i )
+                seen[i] = &SimContext::current();
+        } );
+        util::parallel::setNumThreads( 1 );
+        for( size_t i = 0; i < seen.size(); ++i )
+            TS_ASSERT_EQUALS( seen[i], &other );
+    }
+    
+private:
+    // Configure monitoring (shared by all contexts): two surveys, two age
+    // groups, an integer and a floating-point measure. The configuration is
+    // process-wide, so tearDown() restores it.
+    void initMonitoring(){
+        savedSurveys.reset( new scnXml::Surveys( dummyXML::surveys ) );
+        savedSurvOpts.reset( new scnXml::MonitoringOptions( dummyXML::survOpts ) );
+        savedMonAgeGroup.reset( new scnXml::MonAgeGroup( dummyXML::monAgeGroup ) );
+        savedMonitoring.reset( new scnXml::Monitoring( dummyXML::monitoring ) );
+        dummyXML::surveys.getSurveyTime().push_back( scnXml::SurveyTime( "2t" ) );
+        dummyXML::monitoring.setSurveys( dummyXML::surveys );
+        dummyXML::survOpts.getOption().push_back( scnXml::MonitoringOption( "nUncomp" ) );
+        dummyXML::survOpts.getOption().push_back( scnXml::MonitoringOption( "innoculationsPerAgeGroup" ) );
+        dummyXML::monitoring.setSurveyOptions( dummyXML::survOpts );
+        dummyXML::monAgeGroup.getGroup().push_back( scnXml::MonGroupBounds( 5 ) );
+        dummyXML::monAgeGroup.getGroup().push_back( scnXml::MonGroupBounds( 90 ) );
+        dummyXML::monitoring.setAgeGroup( dummyXML::monAgeGroup );
+        dummyXML::scenario.setMonitoring( dummyXML::monitoring );
+        mon::readSurveyDates( dummyXML::monitoring );
+        mon::initReporting( dummyXML::scenario );
+    }
+    // Undo initMonitoring(), if used
+    void restoreMonitoring(){
+        if( !savedMonitoring ) return;
+        mon::clearReporting();
+        dummyXML::surveys = *savedSurveys;
+        dummyXML::survOpts = *savedSurvOpts;
+        dummyXML::monAgeGroup = *savedMonAgeGroup;
+        dummyXML::monitoring = *savedMonitoring;
+        dummyXML::scenario.setMonitoring( dummyXML::monitoring );
+        mon::readSurveyDates( dummyXML::monitoring );
+        savedSurveys.reset();
+        savedSurvOpts.reset();
+        savedMonAgeGroup.reset();
+        savedMonitoring.reset();
+    }
+    
+    // Report for the current context, then conclude the survey: n
+    // uncomplicated episodes (n in the first age group, 2 n in the second)
+    // and n / 10 inoculations
+    static void report( int survey, int n ){
+        mon::AgeGroup young, old;
+        young.update( SimTime::fromYearsD( 1 ) );
+        old.update( SimTime::fromYearsD( 30 ) );
+        const size_t num = mon::eventSurveyNumber();
+        TS_ASSERT_EQUALS( num, size_t(survey) );
+        mon::reportMSACI( mon::MHE_UNCOMPLICATED_EPISODES, num, young, 0, n );
+        mon::reportMSACI( mon::MHE_UNCOMPLICATED_EPISODES, num, old, 0, 2 * n );
+        mon::reportMSACI( mon::MHE_UNCOMPLICATED_EPISODES, num, old, 0, n );
+        mon::reportStatMACGF( mon::MVF_INOCS, young.i(), 0, 0, n / 10.0 );
+        mon::concludeSurvey();
+    }
+    
+    static string output( SimContext& ctx ){
+        SimContext::Bind bind( ctx );
+        std::ostringstream stream;
+        mon::internal::write( stream );
+        return stream.str();
+    }
+    
+    unique_ptr<scnXml::Surveys> savedSurveys;
+    unique_ptr<scnXml::MonitoringOptions> savedSurvOpts;
+    unique_ptr<scnXml::MonAgeGroup> savedMonAgeGroup;
+    unique_ptr<scnXml::Monitoring> savedMonitoring;
+};
+
+#endif
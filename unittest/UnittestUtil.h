@@ -38,6 +38,8 @@
 #include "WithinHost/Infection/MolineauxInfection.h"
 #include "WithinHost/Genotypes.h"
 #include "mon/management.h"
+#include "Population.h"
+#include "PopulationAgeStructure.h"
 
 #include "schema/scenario.h"
 
@@ -265,16 +267,34 @@ public:
         sim::init( dummyXML::scenario );
         
         // we could just use zero, but we may spot more errors by using some weird number
-        sim::s_t0 = SimTime::fromYearsN(83.2591);
-        sim::s_t1 = sim::s_t0;
+        sim::s_clock->t0 = SimTime::fromYearsN(83.2591);
+        sim::s_clock->t1 = sim::s_clock->t0;
 #ifndef NDEBUG
-        sim::in_update = true;  // may not always be correct but we're more interested in getting around this check than using it in unit tests
+        sim::s_clock->in_update = true;  // may not always be correct but we're more interested in getting around this check than using it in unit tests
 #endif
     }
+    // Set up the Ifakara age structure (as in the test scenarios). Call
+    // initTime() first.
+    static void initAgeStructure(){
+        const double percent[] = { 3.474714994, 12.76004028, 14.52151394,
+            12.75565434, 10.83632374, 8.393312454, 7.001421452, 5.800587654,
+            5.102136612, 4.182561874, 3.339409351, 2.986112356, 2.555766582,
+            2.332763433, 1.77400255, 1.008525491, 0.74167341, 0.271863401,
+            0.161614642 };
+        const double upper[] = { 1, 5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 55,
+            60, 65, 70, 75, 80, 85, 90 };
+        scnXml::DemogAgeGroup ageGroup( 0.0 );
+        for( size_t i = 0; i < sizeof(upper) / sizeof(upper[0]); ++i ){
+            ageGroup.getGroup().push_back( scnXml::DemogGroupBounds( percent[i], upper[i] ) );
+        }
+        dummyXML::demography.setAgeGroup( ageGroup );
+        dummyXML::scenario.setDemography( dummyXML::demography );
+        AgeStructure::init( dummyXML::scenario.getDemography() );
+    }
     static void incrTime(SimTime incr){
         //NOTE: for unit tests, we do not differentiate between s_t0 and s_t1
-        sim::s_t0 += incr;
-        sim::s_t1 = sim::s_t0;
+        sim::s_clock->t0 += incr;
+        sim::s_clock->t1 = sim::s_clock->t0;
     }
     
     static const scnXml::Parameters& prepareParameters(){
@@ -472,9 +492,29 @@ public:
         pkpd.medicateQueue.clear();
     }
     
+    /// Number of drug factors memorised by each drug, summed
+    static size_t numCachedDrugFactors( const PkPd::LSTMModel& pkpd ){
+        size_t n = 0;
+        for( const unique_ptr<PkPd::LSTMDrug>& drug : pkpd.m_drugs ){
+            n += drug->factorCache.size();
+        }
+        return n;
+    }
+    
+    // The Population used by tests. There is only one, since Population
+    // registers continuous-output callbacks, which may only be done once.
+    static Population& testPopulation(){
+        static Population population( 0 );
+        return population;
+    }
+    
     static unique_ptr<Host::Human> createHuman(SimTime dateOfBirth){
         return unique_ptr<Host::Human>( new Host::Human(dateOfBirth, 0) );
     }
+    // Flag a human for removal, as Human::update does when the human dies
+    static void setHumanRemove(Host::Human& human){
+        human.m_remove = true;
+    }
     // Set the WithinHost model used by the human, and return a pointer to it. Do not delete this!
     static WithinHost::WHInterface* setHumanWH(Host::Human& human, unique_ptr<WithinHost::WHInterface> wh){
         human.withinHostModel = move(wh);
@@ -0,0 +1,217 @@
+/*
+ This file is part of OpenMalaria.
+ 
+ Copyright (C) 2005-2014 Swiss Tropical and Public Health Institute
+ Copyright (C) 2005-2014 Liverpool School Of Tropical Medicine
+ 
+ OpenMalaria is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or (at
+ your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef Hmod_VectorWarmupSampleSuite
+#define Hmod_VectorWarmupSampleSuite
+
+#include <cxxtest/TestSuite.h>
+#include "UnittestUtil.h"
+#include "Population.h"
+#include "Transmission/TransmissionModel.h"
+#include "Transmission/Anopheles/MosqTransmission.h"
+#include "Transmission/Anopheles/FixedEmergence.h"
+#include "util/random.h"
+
+using OM::Transmission::TransmissionModel;
+using OM::Transmission::Anopheles::MosqTransmission;
+using OM::Transmission::Anopheles::FixedEmergence;
+using OM::util::vecDay;
+using OM::util::vecDay2D;
+
+/** Vector fitting on a sample of the population (--vector-warmup-sample):
+ * selection of the sample, swapping it with the full population, the
+ * weighting of the sums passed to the mosquito model and the re-indexing of
+ * the mosquito state after the sample. */
+class VectorWarmupSampleSuite : public CxxTest::TestSuite
+{
+public:
+    void setUp () {
+        UnittestUtil::initTime( 5 );
+    }
+    
+    void testSelectSample () {
+        const size_t N = 2000, n = 150;
+        vector<double> ages( N ), het( N );
+        LocalRng rng( 3, 4 );
+        for( size_t i = 0; i < N; ++i ){
+            ages[i] = 90.0 * (N - i) / N;       // oldest first, as the population
+            het[i] = rng.uniform_01();
+        }
+        LocalRng a( 5, 6 ), b( 5, 6 );
+        const vector<size_t> selected = Population::selectSample( ages, het, n, a );
+        TS_ASSERT_EQUALS( selected.size(), n );
+        for( size_t k = 1; k < selected.size(); ++k )
+            TS_ASSERT_LESS_THAN( selected[k - 1], selected[k] );    // ordered, no repeats
+        TS_ASSERT_LESS_THAN( selected.back(), N );
+        TS_ASSERT( Population::selectSample( ages, het, n, b ) == selected );
+        
+        // Allocation is proportional in each of the four heterogeneity
+        // strata of an age band, so the band's share is off by less than four
+        const double ageBounds[] = { 1.0, 5.0, 10.0, 15.0, 25.0, 45.0, 100.0 };
+        double lower = 0.0;
+        for( double upper : ageBounds ){
+            size_t inBand = 0, selectedInBand = 0;
+            for( size_t i = 0; i < N; ++i )
+                if( ages[i] >= lower && ages[i] < upper ) ++inBand;
+            for( size_t i : selected )
+                if( ages[i] >= lower && ages[i] < upper ) ++selectedInBand;
+            TS_ASSERT_DELTA( double(selectedInBand), double(n) * inBand / N, 4.0 );
+            lower = upper;
+        }
+    }
+    
+    void testSampleSwap () {
+        Population& pop = UnittestUtil::testPopulation();
+        pop.population.clear();
+        for( int i = 0; i < 10; ++i ){
+            pop.population.push_back( std::move( *UnittestUtil::createHuman( sim::now() - SimTime::fromYearsI( 50 - i ) ) ) );
+        }
+        pop.populationSize = 10;
+        
+        Population::HumanPop sample;
+        sample.push_back( std::move( *UnittestUtil::createHuman( sim::now() - SimTime::fromYearsI( 70 ) ) ) );
+        sample.push_back( std::move( *UnittestUtil::createHuman( sim::now() - SimTime::fromYearsI( 60 ) ) ) );
+        sample.push_back( std::move( *UnittestUtil::createHuman( sim::now() - SimTime::fromYearsI( 5 ) ) ) );
+        sample.push_back( std::move( *UnittestUtil::createHuman( sim::now() - SimTime::fromYearsI( 1 ) ) ) );
+        pop.swapInSample( sample );
+        TS_ASSERT( sample.empty() );
+        TS_ASSERT_EQUALS( pop.size(), 4u );
+        TS_ASSERT_EQUALS( pop.getSampleWeight(), 2.5 );
+        TS_ASSERT_EQUALS( pop.cbegin()->getDateOfBirth(), sim::now() - SimTime::fromYearsI( 70 ) );
+        
+        pop.endSample();
+        TS_ASSERT_EQUALS( pop.size(), 10u );
+        TS_ASSERT_EQUALS( pop.getSampleWeight(), 1.0 );
+        TS_ASSERT( pop.fullPopulation.empty() );
+        int i = 0;
+        for( Population::ConstIter it = pop.cbegin(); it != pop.cend(); ++it, ++i ){
+            TS_ASSERT_EQUALS( it->getDateOfBirth(), sim::now() - SimTime::fromYearsI( 50 - i ) );
+        }
+        TS_ASSERT_EQUALS( i, 10 );
+        pop.population.clear();
+        pop.populationSize = 0;
+    }
+    
+    // vectorUpdate passes the mosquito model sums over the population, with
+    // each human of a sample weighted; a sample of each human twice with
+    // weight one must give the same sums as each human once with weight two
+    void testWeightedSums () {
+        const size_t N = 50, nSpecies = 2, nGenotypes = 3;
+        TransmissionModel::HostSnapshot once, twice;
+        once.resize( N, nSpecies, nGenotypes );
+        twice.resize( 2 * N, nSpecies, nGenotypes );
+        LocalRng rng( 7, 8 );
+        for( size_t i = 0; i < N; ++i ){
+            for( size_t s = 0; s < nSpecies; ++s ){
+                const double avail = rng.uniform_01(), df = avail * rng.uniform_01(),
+                    fecundity = 0.5 + rng.uniform_01();
+                once.avail[s * N + i] = avail;
+                once.df[s * N + i] = df;
+                once.fecundity[s * N + i] = fecundity;
+                for( size_t j = 2 * i; j < 2 * i + 2; ++j ){
+                    twice.avail[s * 2 * N + j] = avail;
+                    twice.df[s * 2 * N + j] = df;
+                    twice.fecundity[s * 2 * N + j] = fecundity;
+                }
+            }
+            for( size_t g = 0; g < nGenotypes; ++g ){
+                const double p = rng.uniform_01();
+                once.pTransmit[g * N + i] = p;
+                twice.pTransmit[g * 2 * N + 2 * i] = p;
+                twice.pTransmit[g * 2 * N + 2 * i + 1] = p;
+            }
+        }
+        
+        for( size_t s = 0; s < nSpecies; ++s ){
+            double avail1, df1, dff1, avail2, df2, dff2;
+            vector<double> dif1( nGenotypes ), dif2( nGenotypes );
+            once.sumSpecies( s, 2.0, avail1, df1, dff1, dif1 );
+            twice.sumSpecies( s, 1.0, avail2, df2, dff2, dif2 );
+            TS_ASSERT_DELTA( avail1, avail2, 1e-12 * avail2 );
+            TS_ASSERT_DELTA( df1, df2, 1e-12 * df2 );
+            TS_ASSERT_DELTA( dff1, dff2, 1e-12 * dff2 );
+            for( size_t g = 0; g < nGenotypes; ++g )
+                TS_ASSERT_DELTA( dif1[g], dif2[g], 1e-12 * dif2[g] );
+            
+            double sum = 0.0;
+            for( size_t i = 0; i < N; ++i ) sum += once.df[s * N + i] * once.fecundity[s * N + i];
+            TS_ASSERT_DELTA( dff1, 2.0 * sum, 1e-12 * sum );
+        }
+    }
+    
+    // The sample is simulated a whole number of years ahead of the main
+    // simulation; shifting the mosquito state by offset moves the entries of
+    // each day d of its ring buffers (length L) to index (d - offset) mod L
+    void testShiftTime () {
+        const SimTime L = SimTime::fromDays( 11 );     // does not divide a year
+        const size_t nGenotypes = 2;
+        for( int years = -1; years <= 2; ++years ){
+            const SimTime offset = SimTime::fromYearsI( years );
+            MosqTransmission mosq;
+            FixedEmergence *emergence = new FixedEmergence();
+            mosq.emergence.reset( emergence );
+            mosq.N_v_length = L;
+            vecDay<double> *arrays[] = { &mosq.P_A, &mosq.P_df, &mosq.P_dff,
+                &mosq.N_v, &mosq.uninfected_v };
+            vecDay2D<double> *arrays2D[] = { &mosq.P_dif, &mosq.O_v, &mosq.S_v };
+            for( size_t k = 0; k < 5; ++k ) fill( *arrays[k], L, 100.0 * k );
+            for( size_t k = 0; k < 3; ++k ) fill( *arrays2D[k], L, nGenotypes, 100.0 * k );
+            const SimTime Q = emergence->quinquennialS_v.size();
+            fill( emergence->quinquennialS_v, Q, 0.0 );
+            mosq.fLastDay = SimTime::fromDays( 3 );
+            
+            mosq.shiftTime( offset );
+            
+            for( SimTime d = SimTime::zero(); d < L; d += SimTime::oneDay() ){
+                const SimTime i = mod_nn( d - offset, L );
+                for( size_t k = 0; k < 5; ++k )
+                    TS_ASSERT_EQUALS( (*arrays[k])[i], 100.0 * k + d.inDays() );
+                for( size_t k = 0; k < 3; ++k ){
+                    for( size_t g = 0; g < nGenotypes; ++g )
+                        TS_ASSERT_EQUALS( arrays2D[k]->at( i, g ), 100.0 * k + d.inDays() + 0.5 * g );
+                }
+            }
+            for( SimTime d = SimTime::zero(); d < Q; d += SimTime::oneDay() ){
+                TS_ASSERT_EQUALS( emergence->quinquennialS_v[mod_nn( d - offset, Q )], double(d.inDays()) );
+            }
+            TS_ASSERT_EQUALS( mosq.fLastDay, SimTime::never() );   // cache invalidated
+        }
+    }
+    
+private:
+    // Set arr[d] = base + d for days d of a ring buffer of length L
+    static void fill( vecDay<double>& arr, SimTime L, double base ){
+        arr.assign( L, 0.0 );
+        for( SimTime d = SimTime::zero(); d < L; d += SimTime::oneDay() )
+            arr[d] = base + d.inDays();
+    }
+    // Set arr.at(d, g) = base + d + g / 2 for days d and genotypes g
+    static void fill( vecDay2D<double>& arr, SimTime L, size_t nGenotypes, double base ){
+        arr.assign( L, nGenotypes, 0.0 );
+        for( SimTime d = SimTime::zero(); d < L; d += SimTime::oneDay() ){
+            for( size_t g = 0; g < nGenotypes; ++g )
+                arr.at( d, g ) = base + d.inDays() + 0.5 * g;
+        }
+    }
+};
+
+#endif
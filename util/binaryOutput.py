@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+This file is part of OpenMalaria.
+
+Copyright (C) 2005-2015 Swiss Tropical and Public Health Institute
+Copyright (C) 2005-2015 Liverpool School Of Tropical Medicine
+
+OpenMalaria is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+Reader for binary survey output (openMalaria --output-format binary).
+
+The format is described in model/mon/management.h (mon::internal::writeBinary).
+Usage: binaryOutput.py output.bin [output.txt]
+converts to the text format of output.txt (written to stdout if no second
+argument is given). Files compressed with --compress-output are also read.
+"""
+
+import sys
+import math
+import gzip
+import struct
+import unittest
+
+MAGIC = b"OMSURVEY"
+VERSION = 1
+INT32 = 0
+FLOAT64 = 1
+
+class Block(object):
+    """One output measure: header fields plus values.
+
+    values[s][r] is the value of row r in survey s (s counts from 0; there
+    is only one survey if perSurvey is false)."""
+    __slots__ = ["measure", "valueType", "perSurvey", "dims", "rows", "values"]
+
+class BinaryOutput(object):
+    """Contents of a binary output file."""
+    def __init__(self, nSurveys, blocks):
+        self.nSurveys = nSurveys
+        self.blocks = blocks
+
+    def entries(self):
+        """Yield (survey, group, measure, value) tuples in the order of
+        output.txt (survey and group as written in the text file)."""
+        for s in range(self.nSurveys):
+            for b in self.blocks:
+                if not b.perSurvey:
+                    continue
+                for r in range(len(b.rows)):
+                    yield (s + 1, b.rows[r], b.measure, b.values[s][r])
+        for b in self.blocks:
+            if b.perSurvey:
+                continue
+            for r in range(len(b.rows)):
+                yield (1, b.rows[r], b.measure, b.values[0][r])
+
+    def writeText(self, stream):
+        """Write in the format of output.txt"""
+        for survey, group, measure, value in self.entries():
+            stream.write("{0}\t{1}\t{2}\t{3}\n".format(survey, group, measure,
+                    formatValue(value)))
+
+def formatValue(value):
+    """Format as C++ streams do by default (and as OpenMalaria formats
+    non-finite values)."""
+    if isinstance(value, int):
+        return str(value)
+    if math.isnan(value):
+        return "-nan" if math.copysign(1.0, value) < 0 else "nan"
+    if math.isinf(value):
+        return "-inf" if value < 0 else "inf"
+    return "%g" % value
+
+class Reader(object):
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+    def read(self, fmt):
+        size = struct.calcsize(fmt)
+        if self.pos + size > len(self.data):
+            raise Exception("unexpected end of binary output file")
+        values = struct.unpack_from(fmt, self.data, self.pos)
+        self.pos += size
+        return values
+
+def parse(data):
+    """Parse binary output from a bytes object"""
+    r = Reader(data)
+    if r.read("<8s")[0] != MAGIC:
+        raise Exception("not an OpenMalaria binary output file")
+    version, nSurveys, nBlocks = r.read("<3I")
+    if version != VERSION:
+        raise Exception("unsupported binary output version: {0}".format(version))
+    blocks = []
+    for i in range(nBlocks):
+        b = Block()
+        b.measure, b.valueType, perSurvey, _, _ = r.read("<i4B")
+        b.perSurvey = perSurvey != 0
+        b.dims = r.read("<5I")
+        nRows = r.read("<I")[0]
+        b.rows = r.read("<{0}i".format(nRows))
+        if b.valueType not in (INT32, FLOAT64):
+            raise Exception("unknown value type: {0}".format(b.valueType))
+        blocks.append(b)
+    for b in blocks:
+        code = "i" if b.valueType == INT32 else "d"
+        fmt = "<{0}{1}".format(len(b.rows), code)
+        b.values = [r.read(fmt) for s in range(nSurveys if b.perSurvey else 1)]
+    if r.pos != len(data):
+        raise Exception("unexpected data at end of binary output file")
+    return BinaryOutput(nSurveys, blocks)
+
+def readFile(path):
+    """Read a binary output file (optionally gzip-compressed)"""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:2] == b"\x1f\x8b":
+        data = gzip.decompress(data)
+    return parse(data)
+
+class TestBinaryOutput(unittest.TestCase):
+    def build(self):
+        # Two surveys; an integer measure with two age groups and an
+        # IMR-like single value.
+        data = MAGIC + struct.pack("<3I", VERSION, 2, 2)
+        data += struct.pack("<i4B5II2i", 0, INT32, 1, 0, 0, 2, 1, 1, 1, 1, 2, 1, 2)
+        data += struct.pack("<i4B5II1i", 18, FLOAT64, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1)
+        data += struct.pack("<4i", 10, 20, 11, 21)
+        data += struct.pack("<d", 0.125)
+        return data
+    def testText(self):
+        import io
+        out = io.StringIO()
+        parse(self.build()).writeText(out)
+        self.assertEqual(out.getvalue(), "1\t1\t0\t10\n1\t2\t0\t20\n"
+            "2\t1\t0\t11\n2\t2\t0\t21\n1\t1\t18\t0.125\n")
+    def testFormat(self):
+        self.assertEqual(formatValue(1234567.0), "1.23457e+06")
+        self.assertEqual(formatValue(float("inf")), "inf")
+    def testTruncated(self):
+        self.assertRaises(Exception, parse, self.build()[:-1])
+
+def main(args):
+    if len(args) < 2 or len(args) > 3:
+        print("Usage: {0} output.bin [output.txt]".format(args[0]))
+        return 1
+    output = readFile(args[1])
+    if len(args) == 3:
+        with open(args[2], "w") as f:
+            output.writeText(f)
+    else:
+        output.writeText(sys.stdout)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))